@@ -0,0 +1,223 @@
+#include <math.h>
+#include <stddef.h>
+#include "AHRS.h"
+
+
+float __AHRS_inv_sqrt(float x) {
+#ifdef AHRS_FAST_INV_SQRT
+	//!< Без FPU sqrtf и деление стоят сотни тактов. Начальное приближение по битам float и две итерации Ньютона
+	//!< дают относительную погрешность около 1e-6
+	union {
+		float f;
+		int32_t i;
+	} v = { .f = x };
+	float half = 0.5f * x;
+	v.i = 0x5F3759DF - (v.i >> 1);
+	v.f = v.f * (1.5f - half * v.f * v.f);
+	v.f = v.f * (1.5f - half * v.f * v.f);
+	return v.f;
+#else
+	return 1.0f / sqrtf(x);
+#endif /* AHRS_FAST_INV_SQRT */
+}
+
+
+uint8_t __AHRS_normalize(float *v, const float *src) {
+	float norm = src[0] * src[0] + src[1] * src[1] + src[2] * src[2];
+	if (norm == 0.0f) return 0;
+
+	norm = __AHRS_inv_sqrt(norm);
+	v[0] = src[0] * norm;
+	v[1] = src[1] * norm;
+	v[2] = src[2] * norm;
+	return 1;
+}
+
+
+void __AHRS_integrate(AHRS_t *ahrs, const float *w, const float *s, float dt) {
+	float *q = ahrs->q;
+
+	//!< Производная кватерниона от угловой скорости минус шаг коррекции (для Mahony коррекция уже внесена в w)
+	float dq0 = 0.5f * (-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]) - s[0];
+	float dq1 = 0.5f * ( q[0] * w[0] + q[2] * w[2] - q[3] * w[1]) - s[1];
+	float dq2 = 0.5f * ( q[0] * w[1] - q[1] * w[2] + q[3] * w[0]) - s[2];
+	float dq3 = 0.5f * ( q[0] * w[2] + q[1] * w[1] - q[2] * w[0]) - s[3];
+
+	q[0] += dq0 * dt;
+	q[1] += dq1 * dt;
+	q[2] += dq2 * dt;
+	q[3] += dq3 * dt;
+
+	float norm = __AHRS_inv_sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	q[0] *= norm;
+	q[1] *= norm;
+	q[2] *= norm;
+	q[3] *= norm;
+}
+
+
+void __AHRS_earth_field(const float *q, const float *m, float *b) {
+	//!< Поворот измерения магнитометра в земную систему и сброс горизонтальной составляющей на ось X
+	float q00 = q[0] * q[0], q11 = q[1] * q[1], q22 = q[2] * q[2], q33 = q[3] * q[3];
+	float q01 = q[0] * q[1], q02 = q[0] * q[2], q03 = q[0] * q[3];
+	float q12 = q[1] * q[2], q13 = q[1] * q[3], q23 = q[2] * q[3];
+
+	float hx = m[0] * (q00 + q11 - q22 - q33) + 2.0f * m[1] * (q12 - q03) + 2.0f * m[2] * (q02 + q13);
+	float hy = 2.0f * m[0] * (q12 + q03) + m[1] * (q00 - q11 + q22 - q33) + 2.0f * m[2] * (q23 - q01);
+	float hz = 2.0f * m[0] * (q13 - q02) + 2.0f * m[1] * (q01 + q23) + m[2] * (q00 - q11 - q22 + q33);
+
+	float h = hx * hx + hy * hy;
+	b[0] = h * __AHRS_inv_sqrt(h > 0.0f ? h : 1.0f);
+	b[1] = hz;
+}
+
+
+void __AHRS_madgwick(AHRS_t *ahrs, const float *a, const float *m, float *s) {
+	const float *q = ahrs->q;
+
+	//!< Ошибка направления силы тяжести и ее градиент по кватерниону
+	float f0 = 2.0f * (q[1] * q[3] - q[0] * q[2]) - a[0];
+	float f1 = 2.0f * (q[0] * q[1] + q[2] * q[3]) - a[1];
+	float f2 = 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]) - a[2];
+
+	s[0] = -2.0f * q[2] * f0 + 2.0f * q[1] * f1;
+	s[1] =  2.0f * q[3] * f0 + 2.0f * q[0] * f1 - 4.0f * q[1] * f2;
+	s[2] = -2.0f * q[0] * f0 + 2.0f * q[3] * f1 - 4.0f * q[2] * f2;
+	s[3] =  2.0f * q[1] * f0 + 2.0f * q[2] * f1;
+
+	if (m) {
+		//!< Ошибка направления магнитного поля относительно земного вектора (bx, 0, bz)
+		float b[2];
+		__AHRS_earth_field(q, m, b);
+		float bx = b[0], bz = b[1];
+
+		float g0 = bx * (1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) + 2.0f * bz * (q[1] * q[3] - q[0] * q[2]) - m[0];
+		float g1 = 2.0f * bx * (q[1] * q[2] - q[0] * q[3]) + 2.0f * bz * (q[0] * q[1] + q[2] * q[3]) - m[1];
+		float g2 = 2.0f * bx * (q[0] * q[2] + q[1] * q[3]) + bz * (1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2])) - m[2];
+
+		s[0] += -2.0f * bz * q[2] * g0 + (-2.0f * bx * q[3] + 2.0f * bz * q[1]) * g1 + 2.0f * bx * q[2] * g2;
+		s[1] +=  2.0f * bz * q[3] * g0 + ( 2.0f * bx * q[2] + 2.0f * bz * q[0]) * g1 + (2.0f * bx * q[3] - 4.0f * bz * q[1]) * g2;
+		s[2] += (-4.0f * bx * q[2] - 2.0f * bz * q[0]) * g0 + (2.0f * bx * q[1] + 2.0f * bz * q[3]) * g1 + (2.0f * bx * q[0] - 4.0f * bz * q[2]) * g2;
+		s[3] += (-4.0f * bx * q[3] + 2.0f * bz * q[1]) * g0 + (-2.0f * bx * q[0] + 2.0f * bz * q[2]) * g1 + 2.0f * bx * q[1] * g2;
+	}
+
+	//!< Шаг градиентного спуска нормируется, его длина задается beta
+	float norm = s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3];
+	if (norm == 0.0f) return;
+	norm = ahrs->gain[0] * __AHRS_inv_sqrt(norm);
+	s[0] *= norm;
+	s[1] *= norm;
+	s[2] *= norm;
+	s[3] *= norm;
+}
+
+
+void __AHRS_mahony(AHRS_t *ahrs, const float *a, const float *m, float *w, float dt) {
+	const float *q = ahrs->q;
+
+	//!< Ожидаемое направление силы тяжести в системе датчика, ошибка - векторное произведение с измеренным
+	float v0 = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+	float v1 = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+	float v2 = 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]);
+
+	float e0 = a[1] * v2 - a[2] * v1;
+	float e1 = a[2] * v0 - a[0] * v2;
+	float e2 = a[0] * v1 - a[1] * v0;
+
+	if (m) {
+		float b[2];
+		__AHRS_earth_field(q, m, b);
+		float bx = b[0], bz = b[1];
+
+		float u0 = bx * (1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) + 2.0f * bz * (q[1] * q[3] - q[0] * q[2]);
+		float u1 = 2.0f * bx * (q[1] * q[2] - q[0] * q[3]) + 2.0f * bz * (q[0] * q[1] + q[2] * q[3]);
+		float u2 = 2.0f * bx * (q[0] * q[2] + q[1] * q[3]) + bz * (1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
+
+		e0 += m[1] * u2 - m[2] * u1;
+		e1 += m[2] * u0 - m[0] * u2;
+		e2 += m[0] * u1 - m[1] * u0;
+	}
+
+	float ki = ahrs->gain[1];
+	if (ki > 0.0f) {
+		ahrs->integral[0] += ki * e0 * dt;
+		ahrs->integral[1] += ki * e1 * dt;
+		ahrs->integral[2] += ki * e2 * dt;
+	}
+
+	float kp = ahrs->gain[0];
+	w[0] += kp * e0 + ahrs->integral[0];
+	w[1] += kp * e1 + ahrs->integral[1];
+	w[2] += kp * e2 + ahrs->integral[2];
+}
+
+
+void AHRS_init(AHRS_t *ahrs, uint8_t algorithm, float gain1, float gain2) {
+	ahrs->q[0] = 1.0f;
+	ahrs->q[1] = 0.0f;
+	ahrs->q[2] = 0.0f;
+	ahrs->q[3] = 0.0f;
+	ahrs->gain[0] = gain1;
+	ahrs->gain[1] = gain2;
+	ahrs->integral[0] = 0.0f;
+	ahrs->integral[1] = 0.0f;
+	ahrs->integral[2] = 0.0f;
+	ahrs->time = 0;
+	ahrs->algorithm = algorithm;
+	ahrs->started = 0;
+}
+
+
+void AHRS_update(AHRS_t *ahrs, const float *a, const float *g, const float *m, float dt) {
+	float w[3] = { g[0] * AHRS_DEG_TO_RAD, g[1] * AHRS_DEG_TO_RAD, g[2] * AHRS_DEG_TO_RAD };
+	float s[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	float a_n[3], m_n[3];
+	if (__AHRS_normalize(a_n, a)) {
+		const float *m_used = (m && __AHRS_normalize(m_n, m)) ? m_n : NULL;
+
+		if (ahrs->algorithm == AHRS_MAHONY) {
+			__AHRS_mahony(ahrs, a_n, m_used, w, dt);
+		}
+		else {
+			__AHRS_madgwick(ahrs, a_n, m_used, s);
+		}
+	}
+
+	__AHRS_integrate(ahrs, w, s, dt);
+}
+
+
+void AHRS_replay(AHRS_t *ahrs, const AHRS_record_t *records, uint32_t count, float (*q)[4]) {
+	for (uint32_t n = 0; n < count; n++) {
+		const AHRS_record_t *record = &records[n];
+
+		if (ahrs->started) {
+			//!< Разность беззнаковых меток корректна и при переполнении счетчика мкс
+			float dt = (float)(uint32_t)(record->time - ahrs->time) * 1e-6f;
+			AHRS_update(ahrs, record->a, record->g, record->m, dt);
+		}
+		ahrs->time = record->time;
+		ahrs->started = 1;
+
+		if (q) {
+			q[n][0] = ahrs->q[0];
+			q[n][1] = ahrs->q[1];
+			q[n][2] = ahrs->q[2];
+			q[n][3] = ahrs->q[3];
+		}
+	}
+}
+
+
+void AHRS_get_euler(const AHRS_t *ahrs, float *euler) {
+	const float *q = ahrs->q;
+
+	float sin_pitch = 2.0f * (q[0] * q[2] - q[1] * q[3]);
+	if (sin_pitch > 1.0f) sin_pitch = 1.0f;
+	if (sin_pitch < -1.0f) sin_pitch = -1.0f;
+
+	euler[0] = atan2f(q[0] * q[1] + q[2] * q[3], 0.5f - q[1] * q[1] - q[2] * q[2]) * AHRS_RAD_TO_DEG;
+	euler[1] = asinf(sin_pitch) * AHRS_RAD_TO_DEG;
+	euler[2] = atan2f(q[1] * q[2] + q[0] * q[3], 0.5f - q[2] * q[2] - q[3] * q[3]) * AHRS_RAD_TO_DEG;
+}
@@ -0,0 +1,130 @@
+/**
+ * @defgroup AHRS
+ * @brief Оценка ориентации по инерциальному датчику LSM6DS33 и магнитометру LIS3MDL. Ориентация хранится в виде кватерниона.
+ * @details Реализованы два фильтра: градиентный фильтр Madgwick и комплементарный фильтр Mahony. Оба принимают
+ * 	измерения в тех единицах, в которых их возвращают драйверы: угловые скорости в град/с из @ref LSM6DS33_get_all_measure,
+ * 	ускорения и магнитное поле в любых единицах, так как используются только их направления.
+ * 	Оси магнитометра должны совпадать с осями инерциального датчика (при необходимости они согласуются
+ * 	функцией @ref LSM6DS33_config_orientation).
+ *
+ * 	Расчеты выполняются в float без динамической памяти. У STM32F103 нет FPU, и каждая операция float вызывает
+ * 	программную реализацию, поэтому запас по времени при обновлении 1 кГц нужно проверять на своей прошивке, например
+ * 	счетчиком тактов DWT->CYCCNT вокруг @ref AHRS_update.
+ *
+ * 	Модуль не зависит от HAL, поэтому записанный полет можно прогнать через фильтр на ПК быстрее реального времени.
+ * 	Готовая программа для этого, заодно проверяющая точность и скорость фильтров на модели полета, - AHRS_benchmark.c:
+ * 	\code{.c}
+ * 	AHRS_t ahrs;
+ * 	AHRS_record_t record[256];
+ * 	float q[256][4];
+ * 	AHRS_init(&ahrs, AHRS_MADGWICK, 0.1f, 0);
+ * 	while ((count = fread(record, sizeof(AHRS_record_t), 256, log)) > 0) {
+ * 		AHRS_replay(&ahrs, record, count, q);
+ * 		fwrite(q, sizeof(q[0]), count, out);
+ * 	}
+ * 	\endcode
+ */
+/**
+ * @file AHRS.h
+ * @ingroup AHRS
+ * @brief API фильтров ориентации
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef AHRS_H_
+#define AHRS_H_
+
+#include <stdint.h>
+
+/**
+ * @defgroup AHRS_ALGORITHM
+ * @ingroup AHRS
+ * @brief Алгоритм фильтра
+ * @{
+ */
+#define AHRS_MADGWICK						0			//!< Градиентный спуск, один коэффициент beta
+#define AHRS_MAHONY							1			//!< ПИ-регулятор ошибки направления, коэффициенты kp и ki
+/** @} */
+
+#define AHRS_FAST_INV_SQRT								//!< Закомментируйте, чтобы нормировка использовала sqrtf
+
+/** @cond UNNECESSARY */
+#define AHRS_DEG_TO_RAD						0.0174532925f
+#define AHRS_RAD_TO_DEG						57.2957795f
+/** @endcond */
+
+/**
+ * @brief Состояние фильтра
+ */
+typedef struct {
+	float q[4];						//!< Кватернион ориентации: w, x, y, z
+	float gain[2];					//!< beta для Madgwick или kp, ki для Mahony
+	float integral[3];				//!< Интеграл ошибки Mahony в рад/с
+	uint32_t time;					//!< Время последнего измерения при воспроизведении записи в мкс
+	uint8_t algorithm;				//!< Алгоритм @ref AHRS_ALGORITHM "фильтра"
+	uint8_t started;				//!< При воспроизведении записи получено первое измерение
+} AHRS_t;
+
+/**
+ * @brief Запись измерений для воспроизведения полета
+ * @details Формат совпадает с тем, что удобно писать в лог на борту: метка времени и три вектора.
+ * 	Если магнитометр не записывался, поле m заполняется нулями.
+ */
+typedef struct {
+	uint32_t time;					//!< Время измерения в мкс
+	float a[3];						//!< Ускорения
+	float g[3];						//!< Угловые скорости в град/с
+	float m[3];						//!< Магнитное поле
+} AHRS_record_t;
+
+/**
+ * @brief Инициализация фильтра
+ * @ingroup AHRS
+ * @details Ориентация сбрасывается в нулевую. Для Madgwick обычно beta = 0.03..0.1, для Mahony kp = 0.5..2, ki = 0..0.1.
+ *
+ * @param[out] ahrs Состояние фильтра
+ * @param[in] algorithm Алгоритм @ref AHRS_ALGORITHM "фильтра"
+ * @param[in] gain1 beta для Madgwick или kp для Mahony
+ * @param[in] gain2 ki для Mahony, для Madgwick не используется
+ */
+void AHRS_init(AHRS_t *ahrs, uint8_t algorithm, float gain1, float gain2);
+
+/**
+ * @brief Обновление ориентации по одному измерению
+ * @ingroup AHRS
+ * @details Если вектор ускорений нулевой, ориентация только интегрируется по угловым скоростям.
+ * 	Если вектор магнитного поля нулевой или m равен NULL, курс не корректируется.
+ *
+ * @param[in,out] ahrs Состояние фильтра
+ * @param[in] a Ускорения по трем осям
+ * @param[in] g Угловые скорости по трем осям в град/с
+ * @param[in] m Магнитное поле по трем осям. Может быть NULL
+ * @param[in] dt Время с предыдущего обновления в с
+ */
+void AHRS_update(AHRS_t *ahrs, const float *a, const float *g, const float *m, float dt);
+
+/**
+ * @brief Обработка записанных измерений
+ * @ingroup AHRS
+ * @details Интервал между обновлениями вычисляется по меткам времени записей, поэтому запись может обрабатываться
+ * 	кусками. Первая запись после инициализации только задает начальное время.
+ *
+ * @param[in,out] ahrs Состояние фильтра
+ * @param[in] records Массив записей
+ * @param[in] count Количество записей
+ * @param[out] q Массив кватернионов после каждой записи. Может быть NULL
+ */
+void AHRS_replay(AHRS_t *ahrs, const AHRS_record_t *records, uint32_t count, float (*q)[4]);
+
+/**
+ * @brief Получение углов Эйлера
+ * @ingroup AHRS
+ *
+ * @param[in] ahrs Состояние фильтра
+ * @param[out] euler Массив, куда записываются крен, тангаж и рыскание в градусах
+ */
+void AHRS_get_euler(const AHRS_t *ahrs, float *euler);
+
+#endif /* AHRS_H_ */
@@ -0,0 +1,208 @@
+/**
+ * @file AHRS_benchmark.c
+ * @ingroup AHRS
+ * @brief Воспроизведение записанного полета и проверка точности и скорости фильтров на ПК
+ * @details Программа для ПК, в прошивку не входит: без макроса AHRS_BENCHMARK файл пустой. Сборка:
+ * 	\code
+ * 	gcc -O2 -DAHRS_BENCHMARK AHRS_benchmark.c AHRS.c -lm -o AHRS_benchmark
+ * 	\endcode
+ * 	Запуск с записью полета - массивом @ref AHRS_record_t - прогоняет ее через фильтр и сохраняет кватернион после
+ * 	каждой записи как 4 float:
+ * 	\code
+ * 	./AHRS_benchmark flight.bin quaternions.bin [madgwick|mahony]
+ * 	\endcode
+ * 	Без аргументов программа моделирует минутный полет с частотой 1 кГц с известной ориентацией и смещением нуля
+ * 	гироскопа и для обоих алгоритмов выводит ошибку ориентации (без магнитометра - ошибку вертикали) и время
+ * 	одного обновления.
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifdef AHRS_BENCHMARK
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "AHRS.h"
+
+#define AHRS_BENCHMARK_RATE				1000		//!< Частота измерений модели в Гц
+#define AHRS_BENCHMARK_RECORDS			60000		//!< Количество измерений модели: 60 с
+#define AHRS_BENCHMARK_BLOCK			256			//!< Количество записей, читаемых из файла за раз
+#define AHRS_BENCHMARK_REPEATS			20			//!< Количество проходов модели для замера скорости
+
+AHRS_record_t AHRS_benchmark_records[AHRS_BENCHMARK_RECORDS];
+float AHRS_benchmark_truth[AHRS_BENCHMARK_RECORDS][4];
+float AHRS_benchmark_q[AHRS_BENCHMARK_RECORDS][4];
+
+
+double __AHRS_benchmark_seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+void __AHRS_benchmark_rotate(const double *q, const float *v, float *out) {
+	//!< Вектор земной системы координат в системе датчика: поворот на сопряженный кватернион
+	out[0] = v[0] * (1 - 2 * (q[2] * q[2] + q[3] * q[3])) + 2 * v[1] * (q[1] * q[2] + q[0] * q[3]) + 2 * v[2] * (q[1] * q[3] - q[0] * q[2]);
+	out[1] = 2 * v[0] * (q[1] * q[2] - q[0] * q[3]) + v[1] * (1 - 2 * (q[1] * q[1] + q[3] * q[3])) + 2 * v[2] * (q[0] * q[1] + q[2] * q[3]);
+	out[2] = 2 * v[0] * (q[0] * q[2] + q[1] * q[3]) + 2 * v[1] * (q[2] * q[3] - q[0] * q[1]) + v[2] * (1 - 2 * (q[1] * q[1] + q[2] * q[2]));
+}
+
+
+void __AHRS_benchmark_model(uint8_t magnetometer) {
+	//!< Начальная ориентация далека от нулевой, чтобы было видно схождение фильтра
+	double q[4] = { 0.9, 0.2, -0.3, 0.25 };
+	const float gravity[3] = { 0, 0, 9.8f };
+	const float field[3] = { 0.2f, 0, -0.45f };
+	const float bias[3] = { 0.5f, -0.3f, 0.2f };
+	const double dt = 1.0 / AHRS_BENCHMARK_RATE;
+
+	for (uint32_t k = 0; k < AHRS_BENCHMARK_RECORDS; k++) {
+		double n = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+		for (uint8_t i = 0; i < 4; i++) {
+			q[i] /= n;
+			AHRS_benchmark_truth[k][i] = (float)q[i];
+		}
+
+		double t = k * dt;
+		double w[3] = { 0.5 * sin(t), 0.3 * cos(0.7 * t), 0.4 };
+
+		AHRS_record_t *record = &AHRS_benchmark_records[k];
+		record->time = (uint32_t)(k * (1000000 / AHRS_BENCHMARK_RATE));
+		__AHRS_benchmark_rotate(q, gravity, record->a);
+		if (magnetometer) {
+			__AHRS_benchmark_rotate(q, field, record->m);
+		}
+		else {
+			memset(record->m, 0, sizeof(record->m));
+		}
+		for (uint8_t i = 0; i < 3; i++) {
+			record->g[i] = (float)(w[i] * AHRS_RAD_TO_DEG) + bias[i];
+		}
+
+		double dq[4] = {
+			0.5 * (-q[1] * w[0] - q[2] * w[1] - q[3] * w[2]),
+			0.5 * (q[0] * w[0] + q[2] * w[2] - q[3] * w[1]),
+			0.5 * (q[0] * w[1] - q[1] * w[2] + q[3] * w[0]),
+			0.5 * (q[0] * w[2] + q[1] * w[1] - q[2] * w[0])
+		};
+		for (uint8_t i = 0; i < 4; i++) {
+			q[i] += dq[i] * dt;
+		}
+	}
+}
+
+
+double __AHRS_benchmark_error(uint32_t from, uint8_t tilt) {
+	//!< Наибольший угол между оценкой и истинной ориентацией в градусах. Без магнитометра курс не наблюдаем,
+	//!< поэтому сравнивается только направление вертикали
+	const float up[3] = { 0, 0, 1 };
+	double worst = 0;
+	for (uint32_t k = from; k < AHRS_BENCHMARK_RECORDS; k++) {
+		double dot = 0, angle;
+		if (tilt) {
+			double estimate[4], truth[4];
+			float estimate_up[3], truth_up[3];
+			for (uint8_t i = 0; i < 4; i++) {
+				estimate[i] = AHRS_benchmark_q[k][i];
+				truth[i] = AHRS_benchmark_truth[k][i];
+			}
+			__AHRS_benchmark_rotate(estimate, up, estimate_up);
+			__AHRS_benchmark_rotate(truth, up, truth_up);
+			for (uint8_t i = 0; i < 3; i++) {
+				dot += estimate_up[i] * truth_up[i];
+			}
+			angle = acos(dot > 1 ? 1 : dot) * AHRS_RAD_TO_DEG;
+		}
+		else {
+			for (uint8_t i = 0; i < 4; i++) {
+				dot += AHRS_benchmark_q[k][i] * AHRS_benchmark_truth[k][i];
+			}
+			//!< q и -q задают одну ориентацию, угол поворота вдвое больше угла между кватернионами
+			dot = fabs(dot);
+			angle = 2 * acos(dot > 1 ? 1 : dot) * AHRS_RAD_TO_DEG;
+		}
+		if (angle > worst) {
+			worst = angle;
+		}
+	}
+	return worst;
+}
+
+
+void __AHRS_benchmark_run(uint8_t algorithm, uint8_t magnetometer) {
+	AHRS_t ahrs;
+	const char *name = algorithm == AHRS_MADGWICK ? "madgwick" : "mahony";
+
+	__AHRS_benchmark_model(magnetometer);
+
+	AHRS_init(&ahrs, algorithm, algorithm == AHRS_MADGWICK ? 0.1f : 1.0f, 0.05f);
+	AHRS_replay(&ahrs, AHRS_benchmark_records, AHRS_BENCHMARK_RECORDS, AHRS_benchmark_q);
+	double error = __AHRS_benchmark_error(AHRS_BENCHMARK_RECORDS / 2, !magnetometer);
+
+	clock_t start = clock();
+	for (uint32_t r = 0; r < AHRS_BENCHMARK_REPEATS; r++) {
+		AHRS_init(&ahrs, algorithm, algorithm == AHRS_MADGWICK ? 0.1f : 1.0f, 0.05f);
+		AHRS_replay(&ahrs, AHRS_benchmark_records, AHRS_BENCHMARK_RECORDS, AHRS_benchmark_q);
+	}
+	double seconds = __AHRS_benchmark_seconds(start);
+
+	printf("%-8s %s: max %s error %.3f deg over the last 30 s, %.1f ns per update\n", name, magnetometer ? "9-axis" : "6-axis",
+			magnetometer ? "attitude" : "tilt",
+			error, seconds * 1e9 / ((double)AHRS_BENCHMARK_RECORDS * AHRS_BENCHMARK_REPEATS));
+}
+
+
+int __AHRS_benchmark_replay(const char *input, const char *output, uint8_t algorithm) {
+	FILE *log = fopen(input, "rb");
+	if (log == NULL) {
+		perror(input);
+		return 1;
+	}
+	FILE *out = fopen(output, "wb");
+	if (out == NULL) {
+		perror(output);
+		fclose(log);
+		return 1;
+	}
+
+	AHRS_t ahrs;
+	AHRS_record_t record[AHRS_BENCHMARK_BLOCK];
+	float q[AHRS_BENCHMARK_BLOCK][4];
+	size_t count, total = 0;
+
+	AHRS_init(&ahrs, algorithm, algorithm == AHRS_MADGWICK ? 0.1f : 1.0f, 0.05f);
+	clock_t start = clock();
+	while ((count = fread(record, sizeof(AHRS_record_t), AHRS_BENCHMARK_BLOCK, log)) > 0) {
+		AHRS_replay(&ahrs, record, count, q);
+		fwrite(q, sizeof(q[0]), count, out);
+		total += count;
+	}
+	double seconds = __AHRS_benchmark_seconds(start);
+
+	float euler[3];
+	AHRS_get_euler(&ahrs, euler);
+	printf("%zu records in %.3f s, final roll %.1f pitch %.1f yaw %.1f deg\n", total, seconds, euler[0], euler[1], euler[2]);
+
+	fclose(log);
+	fclose(out);
+	return 0;
+}
+
+
+int main(int argc, char **argv) {
+	if (argc >= 3) {
+		uint8_t algorithm = (argc >= 4 && strcmp(argv[3], "mahony") == 0) ? AHRS_MAHONY : AHRS_MADGWICK;
+		return __AHRS_benchmark_replay(argv[1], argv[2], algorithm);
+	}
+
+	for (uint8_t algorithm = AHRS_MADGWICK; algorithm <= AHRS_MAHONY; algorithm++) {
+		__AHRS_benchmark_run(algorithm, 1);
+		__AHRS_benchmark_run(algorithm, 0);
+	}
+
+	return 0;
+}
+
+#endif /* AHRS_BENCHMARK */
@@ -6,6 +6,8 @@ I2C_TypeDef *AHT10_hi2c;
 uint8_t AHT10_RxData[7] = {0,};
 uint8_t AHT10_trigger_data[3] = { AHT10_COMMAND_TRIGGER, 0b00110011, 0 };
 
+AHT10_scheduler_t AHT10_scheduler;
+
 
 HAL_StatusTypeDef AHT10_init(I2C_HandleTypeDef *hi2c_) {
 	HAL_StatusTypeDef status;
@@ -93,3 +95,64 @@ HAL_StatusTypeDef AHT10_get_H(float *hum) {
 HAL_StatusTypeDef AHT10_soft_reset() {
 	return I2C_Master_Transmit(AHT10_hi2c, AHT10_ADDRESS, (uint8_t*)AHT10_COMMAND_RESET, 1, 50);
 }
+
+
+void AHT10_start(uint32_t period) {
+	AHT10_scheduler.period = period;
+	AHT10_scheduler.next = HAL_GetTick();
+	AHT10_scheduler.state = AHT10_STATE_IDLE;
+}
+
+
+HAL_StatusTypeDef AHT10_process() {
+	HAL_StatusTypeDef status;
+
+	uint32_t now = HAL_GetTick();
+	if ((int32_t)(now - AHT10_scheduler.next) < 0) {
+		return HAL_BUSY;
+	}
+
+	if (AHT10_scheduler.state == AHT10_STATE_IDLE) {
+		//! Следующий запуск отсчитывается от запланированного времени, а не от момента вызова, чтобы период не накапливал опоздания.
+		//! Если запуск опоздал больше чем на период, отсчет начинается заново от текущего времени
+		uint32_t trigger = ((now - AHT10_scheduler.next) < AHT10_scheduler.period) ? AHT10_scheduler.next : now;
+
+		if ((status = AHT10_trigger_measure()) != HAL_OK) {
+			AHT10_scheduler.errors++;
+			AHT10_scheduler.next = trigger + AHT10_scheduler.period;
+			return status;
+		}
+
+		AHT10_scheduler.trigger = trigger;
+		AHT10_scheduler.started = now;
+		AHT10_scheduler.next = now + AHT10_CONVERSION_TIME;
+		AHT10_scheduler.state = AHT10_STATE_CONVERTING;
+		return HAL_BUSY;
+	}
+
+	float t, hum;
+	if ((status = AHT10_get_measure(&t, &hum)) != HAL_OK) {
+		if (status == HAL_BUSY) {
+			//! Датчик не успел закончить измерение: повторное чтение не раньше чем через AHT10_RETRY_TIME
+			AHT10_scheduler.next = now + AHT10_RETRY_TIME;
+			return status;
+		}
+
+		AHT10_scheduler.errors++;
+	}
+	else {
+		AHT10_scheduler.t = t;
+		AHT10_scheduler.hum = hum;
+		AHT10_scheduler.tick = AHT10_scheduler.started;
+		AHT10_scheduler.count++;
+	}
+
+	//! Если период меньше времени измерения, новый запуск произойдет при следующем вызове
+	AHT10_scheduler.next = AHT10_scheduler.trigger + AHT10_scheduler.period;
+	if ((int32_t)(AHT10_scheduler.next - now) < 0) {
+		AHT10_scheduler.next = now;
+	}
+	AHT10_scheduler.state = AHT10_STATE_IDLE;
+
+	return status;
+}
@@ -19,6 +19,16 @@
  *							HAL_Delay(1000);   
  * 					}  
  * 					\endcode
+ * 					Чтобы не опрашивать занятый датчик, можно использовать неблокирующий планировщик измерений:
+ * 					\code{.c}  
+ * 					AHT10_init(&hi2c1);  
+ * 					AHT10_start(1000);  
+ * 					while(1) {  
+ * 						if (AHT10_process() == HAL_OK) {  
+ * 							log(AHT10_scheduler.tick, AHT10_scheduler.t, AHT10_scheduler.hum);  
+ * 						}  
+ * 					}  
+ * 					\endcode
  * @{
  */
 #ifndef INC_AHT10_HAL_H_
@@ -33,7 +43,7 @@
 #define AHT10_HAL 			//!< Указывает библиотеку STM32, с помощью которой управляется интерфейс I2C. Определите **AHT10_HAL** или **AHT10_LL** в зависимости от используемой библиотеки.
 /** @} */	
 
-#ifdef AH10_HAL
+#ifdef AHT10_HAL
 
 #define I2C_TypeDef 	I2C_HandleTypeDef
 #define I2C_Master_Receive(I2C, DEV_ADR, BUF,BUF_SIZE, TIMEOUT) 		HAL_I2C_Master_Receive(I2C,DEV_ADR,BUF,BUF_SIZE,TIMEOUT)
@@ -65,6 +75,40 @@ extern uint8_t AHT10_trigger_data[3];			//!< Массив для отправк
 #define AHT10_COMMAND_RESET				0b10111010			//!< Код операции программной перезагрузки датчика.
 /** @} */
 
+/**
+ * @name Параметры планировщика измерений
+ * @{
+ */
+#define AHT10_CONVERSION_TIME			80					//!< Время измерения в мс с запасом: по документации ~75мс, плюс один тик HAL_GetTick.
+#define AHT10_RETRY_TIME				10					//!< Задержка повторного чтения в мс, если датчик еще занят.
+/** @} */
+
+/** @cond UNNECESSARY */
+#define AHT10_STATE_IDLE				0
+#define AHT10_STATE_CONVERTING			1
+/** @endcond */
+
+/**
+ * @brief Состояние планировщика измерений
+ */
+typedef struct {
+	float t;									//!< Последняя измеренная температура в градусах Цельсия
+	float hum;									//!< Последняя измеренная влажность в %
+	uint32_t tick;								//!< Время запуска последнего опубликованного измерения в мс (HAL_GetTick)
+	uint32_t count;								//!< Количество опубликованных измерений
+	uint32_t period;							//!< Период измерений в мс
+	uint32_t errors;							//!< Количество ошибок I2C
+
+	/** @cond UNNECESSARY */
+	uint32_t trigger;
+	uint32_t started;
+	uint32_t next;
+	uint8_t state;
+	/** @endcond */
+} AHT10_scheduler_t;
+
+extern AHT10_scheduler_t AHT10_scheduler;		//!< Планировщик измерений. Последнее измерение публикуется в его полях t, hum и tick.
+
 /** 
  * @brief Инициализация датчика.
  * @details Функция инициализации датчика. Используется перед измерением данных. Отправляет код операции инициализации датчику.  
@@ -112,6 +156,24 @@ HAL_StatusTypeDef AHT10_get_H(float *hum);
  */
 HAL_StatusTypeDef AHT10_soft_reset();
 
+/** 
+ * @brief Запуск периодических измерений.
+ * @details Настраивает планировщик @ref AHT10_scheduler. Первое измерение запускается при ближайшем вызове @ref AHT10_process.
+ * Если период меньше времени измерения, следующее измерение запускается сразу после чтения предыдущего.
+ * @param period Период измерений в мс
+ */
+void AHT10_start(uint32_t period);
+
+/** 
+ * @brief Шаг планировщика измерений.
+ * @details Функция для вызова в основном цикле или планировщике задач, не блокирует выполнение. Запускает измерение,
+ * запоминает время запуска и обращается к шине только один раз, когда истечет время измерения **AHT10_CONVERSION_TIME**.
+ * Прочитанные температура и влажность вместе со временем запуска публикуются в @ref AHT10_scheduler.
+ * Измерения запускаются с постоянным периодом относительно времени предыдущего запуска. При ошибке I2C попытка повторяется через период.
+ * @retval status **HAL_OK**, если опубликовано новое измерение, **HAL_BUSY**, если его еще нет, иначе статус I2C при ошибке обмена с датчиком
+ */
+HAL_StatusTypeDef AHT10_process();
+
 #endif /* INC_AHT10_HAL_H_ */
 
 /** @} */
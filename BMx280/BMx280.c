@@ -1,257 +1,550 @@
 #include "BMx280.h"
 #include "math.h"
+#include "string.h"
 
-BMx280_calibration_data calibration_data;
 
-I2C_TypeDef *BMx280_hi2c;
 
-int32_t BMx280_t_fine;
-uint32_t BMx280_refPressure;
-uint32_t BMx280_ADDRESS;
+int32_t __BMx280_compensate_T_int32(BMx280_t *dev, int32_t adc_T) {
+	return BMx280_compensate_T(&dev->calibration_data, adc_T, &dev->t_fine);
+}
 
-int32_t __BMx280_compensate_T_int32(int32_t adc_T) {
-	int32_t var1, var2, T;
+uint32_t __BMx280_compensate_P_int64(BMx280_t *dev, int32_t adc_P) {
+	return BMx280_compensate_P_int64(&dev->calibration_data, dev->t_fine, adc_P);
+}
 
-	var1 = ((((adc_T >> 3) - ((int32_t)calibration_data.dig_T1 << 1))) * ((int32_t)calibration_data.dig_T2)) >> 11;
-	var2 = (((((adc_T >> 4) - ((int32_t)calibration_data.dig_T1)) * ((adc_T >> 4) - ((int32_t)calibration_data.dig_T1))) >> 12) *
-		((int32_t)calibration_data.dig_T3)) >> 14;
-	
-	BMx280_t_fine = var1 + var2;
-	
-	T = (BMx280_t_fine * 5 + 128) >> 8;
-	
-	return T;
+uint32_t __BMx280_compensate_P_int32(BMx280_t *dev, int32_t adc_P) {
+	return BMx280_compensate_P_int32(&dev->calibration_data, dev->t_fine, adc_P);
 }
 
-uint32_t __BMx280_compensate_P_int64(int32_t adc_P) {
-	int64_t var1, var2, p;
+int32_t __BMx280_compensate_H_int32(BMx280_t *dev, int32_t adc_H) {
+	return (int32_t)BMx280_compensate_H(&dev->calibration_data, dev->t_fine, adc_H);
+}
 
-	var1 = ((int64_t)BMx280_t_fine) - 128000;
+void __BMx280_unpack_raw(uint8_t *raw_data, int32_t *adc_P, int32_t *adc_T, int32_t *adc_H) {
+	//!< Данные в регистрах 0xF7..0xFE: давление (20 бит), температура (20 бит), влажность (16 бит, только BME280)
+	*adc_P = (int32_t)(((uint32_t)raw_data[0] << 12) | ((uint32_t)raw_data[1] << 4) | ((uint32_t)raw_data[2] >> 4));
+	*adc_T = (int32_t)(((uint32_t)raw_data[3] << 12) | ((uint32_t)raw_data[4] << 4) | ((uint32_t)raw_data[5] >> 4));
+	if (adc_H != NULL) {
+		*adc_H = (int32_t)(((uint32_t)raw_data[6] << 8) | (uint32_t)raw_data[7]);
+	}
+}
 
-	var2 = var1 * var1 * (int64_t)calibration_data.dig_P6;
-	var2 = var2 + ((var1 * (int64_t)calibration_data.dig_P5) << 17);
-	var2 = var2 + (((int64_t)calibration_data.dig_P4) << 35);
+HAL_StatusTypeDef BMx280_init(BMx280_t *dev, BMx280_BUS_TypeDef *hi2c_, uint16_t address, uint32_t refPressure_) {
+	HAL_StatusTypeDef status;
 
-	var1 = ((var1 * var1 * (int64_t)calibration_data.dig_P3) >> 8) + ((var1 * (int64_t)calibration_data.dig_P2) << 12);
-	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calibration_data.dig_P1) >> 33;
+	uint8_t id = 0;
 
-	if (var1 == 0)
-	{
-		return 0; // avoid exception caused by division by zero
+	if (address != BMx280_ADDRESS_AUTO) {
+		status = I2C_Mem_Read(hi2c_, address, BMx280_REGISTER_ID, &id, 1, 0xFF);
+	}
+	else if ((status = I2C_Mem_Read(hi2c_, BMx280_ADDRESS_0, BMx280_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
+		address = BMx280_ADDRESS_0;
+	}
+	else if ((status = I2C_Mem_Read(hi2c_, BMx280_ADDRESS_1, BMx280_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
+		address = BMx280_ADDRESS_1;
 	}
 
-	p = 1048576 - adc_P;
-	p = (((p << 31) - var2) * 3125) / var1;
+	if (status != HAL_OK) {
+		return status;
+	}
 
-	var1 = (((int64_t)calibration_data.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-	var2 = (((int64_t)calibration_data.dig_P8) * p) >> 19;
+	if ((id != 0x60) && (id != 0x58)) {
+		return HAL_ERROR;
+	}
 
-	p = ((p + var1 + var2) >> 8) + (((int64_t)calibration_data.dig_P7) << 4);
+	dev->hi2c = hi2c_;
+	dev->address = address;
+	dev->id = id;
+	dev->refPressure = refPressure_;
+	dev->t_fine = 0;
+	dev->measure_pending = 0;
+	dev->measure_valid = 0;
 
-	return (uint32_t)p;
-}
+	BMx280_calibration_data *calibration_data = &dev->calibration_data;
+	uint8_t buffer[24];
 
-int32_t __BMx280_compensate_H_int32(int32_t adc_H)
-{
-	int32_t v_x1_u32r;
+	//!< Коэффициенты температуры и давления 0x88..0x9F - 12 слов little-endian, порядок совпадает со структурой
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_CALIBRATION, buffer, 24, 0xFF)) != HAL_OK) {
+		return status;
+	}
+	uint16_t *words = &calibration_data->dig_T1;
+	for (int i = 0; i < 12; i++) {
+		words[i] = (uint16_t)buffer[2 * i] | ((uint16_t)buffer[2 * i + 1] << 8);
+	}
 
-	v_x1_u32r = (BMx280_t_fine - ((int32_t)76800));
-	v_x1_u32r = (((((adc_H << 14) - (((int32_t)calibration_data.dig_H4) << 20) - (((int32_t)calibration_data.dig_H5) *
-		v_x1_u32r)) + ((int32_t)16384)) >> 15) * (((((((v_x1_u32r *
-		((int32_t)calibration_data.dig_H6)) >> 10) * (((v_x1_u32r * ((int32_t)calibration_data.dig_H3)) >> 11) +
-		((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)calibration_data.dig_H2) + 8192) >> 14));
+	//!< У BMP280 нет гигрометра, регистров 0xA1 и 0xE1..0xE7 у него нет
+	if (dev->id == 0x60) {
+		if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_CALIBRATION_H1, &calibration_data->dig_H1, 1, 0xFF)) != HAL_OK) {
+			return status;
+		}
 
-	v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)calibration_data.dig_H1)) >> 4));
-	v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-	v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
+		if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_CALIBRATION_H2, buffer, 7, 0xFF)) != HAL_OK) {
+			return status;
+		}
+		calibration_data->dig_H2 = (int16_t)((uint16_t)buffer[0] | ((uint16_t)buffer[1] << 8));
+		calibration_data->dig_H3 = buffer[2];
+		calibration_data->dig_H4 = (int16_t)(((int8_t)buffer[3] * 16) | (buffer[4] & 0xF));
+		calibration_data->dig_H5 = (int16_t)(((int8_t)buffer[5] * 16) | (buffer[4] >> 4));
+		calibration_data->dig_H6 = (int8_t)buffer[6];
+	}
 
-	return (uint32_t)(v_x1_u32r >> 12);
+	return BMx280_config(dev, 1, 1, 1, 0, 0);
 }
 
-HAL_StatusTypeDef BMx280_init(I2C_TypeDef *hi2c_, uint32_t refPressure_) {
+HAL_StatusTypeDef __BMx280_write_settings(BMx280_t *dev) {
 	HAL_StatusTypeDef status;
 
-	uint8_t id;
+	//!< Значение ctrl_hum применяется только после записи ctrl_meas, поэтому записываем его первым
+	if ((status = I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CTRL_HUM, &dev->sensor_settings.ctrl_hum, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	//!< По I2C адрес регистра при записи не увеличивается, поэтому config записывается отдельно, до ctrl_meas:
+	//!< в нормальном режиме запись в config может быть проигнорирована
+	if ((status = I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CONFIG, &dev->sensor_settings.config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CTRL_MEAS, &dev->sensor_settings.ctrl_meas, 1, 0xFF);
+}
+
+uint32_t __BMx280_oversampling_count(uint8_t OS) {
+	return OS ? (1 << (OS - 1)) : 0;
+}
+
+HAL_StatusTypeDef BMx280_config(BMx280_t *dev, uint8_t T_OS, uint8_t P_OS, uint8_t H_OS, uint8_t STDB, uint8_t IIRF) {
+	if (T_OS > 0b101) T_OS = 0b101;
+	if (P_OS > 0b101) P_OS = 0b101;
+	if (H_OS > 0b101) H_OS = 0b101;
+	if (STDB > 0b111) STDB = 0b111;
+	if (IIRF > 0b100) IIRF = 0b100;
+
+	dev->sensor_settings.ctrl_meas = (T_OS << 5) | (P_OS << 2);
+	dev->sensor_settings.config = (STDB << 5) | (IIRF << 2);
+	dev->sensor_settings.ctrl_hum = H_OS;
+
+	//!< Время измерения по документации в мкс. Количество выборок OVERSAMPLING: 0, 1, 2, 4, 8, 16
+	uint32_t measure_time = 1250 + 2300 * __BMx280_oversampling_count(T_OS);
+	if (P_OS) measure_time += 2300 * __BMx280_oversampling_count(P_OS) + 575;
+	if (H_OS && dev->id == 0x60) measure_time += 2300 * __BMx280_oversampling_count(H_OS) + 575;
+	dev->measure_time = measure_time;
+	
+	return __BMx280_write_settings(dev);
+}
+
+uint32_t BMx280_get_measure_time(BMx280_t *dev) {
+	return dev->measure_time;
+}
+
+uint32_t BMx280_get_period(BMx280_t *dev) {
+	//!< Время ожидания в мкс. Два последних значения у BME280 и BMP280 различаются
+	static const uint32_t standby[8] = {500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000};
+
+	uint8_t T_OS = dev->sensor_settings.ctrl_meas >> 5;
+	uint8_t P_OS = (dev->sensor_settings.ctrl_meas >> 2) & 0b111;
+	uint8_t H_OS = dev->sensor_settings.ctrl_hum & 0b111;
+	uint8_t STDB = dev->sensor_settings.config >> 5;
 
-	if ((status = HAL_I2C_Mem_Read(hi2c_, 0x76 << 1, BMx280_REGISTER_ID, I2C_MEMADD_SIZE_8BIT, &id, 1, 0xFF)) == HAL_OK) {
-		BMx280_ADDRESS = 0x76 << 1;
+	uint32_t period = 1000 + 2000 * __BMx280_oversampling_count(T_OS);
+	if (P_OS) period += 2000 * __BMx280_oversampling_count(P_OS) + 500;
+	if (H_OS && dev->id == 0x60) period += 2000 * __BMx280_oversampling_count(H_OS) + 500;
+
+	if (dev->id == 0x60 && STDB >= 0b110) {
+		period += (STDB == 0b110) ? 10000 : 20000;
 	}
-	else if ((status = HAL_I2C_Mem_Read(hi2c_, 0x77 << 1, BMx280_REGISTER_ID, I2C_MEMADD_SIZE_8BIT, &id, 1, 0xFF)) == HAL_OK) {
-		BMx280_ADDRESS = 0x77 << 1;	
+	else {
+		period += standby[STDB];
 	}
 
-	if ((id == 0x60) || (id == 0x58))  {
-		BMx280_hi2c = hi2c_;
-		BMx280_refPressure = refPressure_;
-		
-		uint8_t H_bytes[3];
+	return period;
+}
 
-		I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CALIBRATION, (uint8_t*)&calibration_data, 28, 0xFF);
-		
-		I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CALIBRATION_H4, H_bytes, 3, 0xFF);
-		calibration_data.dig_H4 = (H_bytes[0] << 4) | (H_bytes[1] & 0xF);
-		calibration_data.dig_H5 = (H_bytes[2] << 4) | (H_bytes[1] >> 4);
-		
-		I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CALIBRATION_H6,(uint8_t*) &calibration_data.dig_H6, 1, 0xFF);
+HAL_StatusTypeDef BMx280_forced_start(BMx280_t *dev) {
+	HAL_StatusTypeDef status;
 
-		BMx280_config(1, 1, 1, 0, 0);
+	dev->sensor_settings.ctrl_meas = (dev->sensor_settings.ctrl_meas & 0xFC) | 0b10;
+	
+	if ((status = I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CTRL_MEAS, &dev->sensor_settings.ctrl_meas, 1, 0xFF)) != HAL_OK) {
+		return status;
 	}
-	return status;
+
+	dev->measure_start = HAL_GetTick();
+	dev->measure_pending = 1;
+
+	return HAL_OK;
 }
 
+HAL_StatusTypeDef BMx280_forced_poll(BMx280_t *dev) {
+	if (!dev->measure_pending) {
+		return HAL_ERROR;
+	}
+
+	//!< Тик мог смениться сразу после запуска, поэтому ждем на один тик (1 мс) больше времени измерения.
+	//!< Сравнение в мс: прошедшее время в мкс переполнило бы 32 бита через 71 минуту
+	if (HAL_GetTick() - dev->measure_start < (dev->measure_time + 1999) / 1000) {
+		return HAL_BUSY;
+	}
 
-HAL_StatusTypeDef BMx280_config(uint8_t T_OS, uint8_t P_OS, uint8_t H_OS, uint8_t STDB, uint8_t IIRF) {
-	if (T_OS < 0) T_OS = 0;
-	else if (T_OS > 0b101) T_OS = 0b101;
-	if (P_OS < 0) P_OS = 0;
-	else if (P_OS > 0b101) P_OS = 0b101;
-	if (H_OS < 0) H_OS = 0;
-	else if (H_OS > 0b101) H_OS = 0b101;
-	if (STDB < 0) STDB = 0;
-	else if (STDB > 0b111) STDB = 0b111;
-	if (IIRF < 0) IIRF = 0;
-	else if (IIRF > 0b100) IIRF = 0b100;
+	return HAL_OK;
+}
 
+HAL_StatusTypeDef __BMx280_forced_read(BMx280_t *dev, uint8_t *raw_data, uint8_t size) {
 	HAL_StatusTypeDef status;
 
-	BMx280_sensor_settings.ctrl_meas = (T_OS << 5) | (P_OS << 2);
-	BMx280_sensor_settings.config = (STDB << 5) | (IIRF << 2);
-	BMx280_sensor_settings.ctrl_hum = H_OS;
-	
+	if ((status = BMx280_forced_poll(dev)) != HAL_OK) {
+		return status;
+	}
+
+	dev->measure_pending = 0;
+
+	return I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, size, 0xFF);
+}
 
-	if ((status = I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_MEAS, (uint8_t*)&BMx280_sensor_settings, 2, 0xFF)) != HAL_OK) {
+HAL_StatusTypeDef BME280_forced_complete(BMx280_t *dev, float *temp, float *press, float *hum, float *h) {
+	HAL_StatusTypeDef status;
+
+	uint8_t raw_data[8];
+	if ((status = __BMx280_forced_read(dev, raw_data, 8)) != HAL_OK) {
 		return status;
 	}
+
+	int32_t ADC_data[3];
+	__BMx280_unpack_raw(raw_data, &ADC_data[0], &ADC_data[1], &ADC_data[2]);
 	
-	if ((status = I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_HUM, &BMx280_sensor_settings.ctrl_hum, 1, 0xFF)) != HAL_OK) {
+	*temp = __BMx280_compensate_T_int32(dev, ADC_data[1]) / 100.f;
+	*press = __BMx280_compensate_P_int64(dev, ADC_data[0]) / 256.f;
+	*hum = __BMx280_compensate_H_int32(dev, ADC_data[2]) / 1024.f;
+	*h = 29.254f * ((*temp) + 273.15f) * logf(dev->refPressure / (*press));
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef BMP280_forced_complete(BMx280_t *dev, float *temp, float *press, float *h) {
+	HAL_StatusTypeDef status;
+
+	uint8_t raw_data[6];
+	if ((status = __BMx280_forced_read(dev, raw_data, 6)) != HAL_OK) {
 		return status;
 	}
+
+	int32_t ADC_data[2];
+	__BMx280_unpack_raw(raw_data, &ADC_data[0], &ADC_data[1], NULL);
+
+	*temp = __BMx280_compensate_T_int32(dev, ADC_data[1]) / 100.f;
+	*press = __BMx280_compensate_P_int64(dev, ADC_data[0]) / 256.f;
+	*h = 29.254f * ((*temp) + 273.15f) * logf(dev->refPressure / (*press));
 	
-	return status;
+	return HAL_OK;
 }
 
-HAL_StatusTypeDef BME280_forced_measure(float *temp, float *press, float *hum, float *h) {
+HAL_StatusTypeDef BME280_forced_measure(BMx280_t *dev, float *temp, float *press, float *hum, float *h) {
 	HAL_StatusTypeDef status;
 
-	BMx280_sensor_settings.ctrl_meas = (BMx280_sensor_settings.ctrl_meas & 0xFC) | 0b10;
-	
-	if ((status = I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_MEAS, (uint8_t*)&BMx280_sensor_settings, 1, 0xFF)) != HAL_OK) {
+	if ((status = BMx280_forced_start(dev)) != HAL_OK) {
 		return status;
 	}
 
-	if ((status = I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_HUM, &BMx280_sensor_settings.ctrl_hum, 1, 0xFF)) != HAL_OK) {
+	//!< Ждем окончания измерения по времени, шина I2C в это время свободна
+	while (BMx280_forced_poll(dev) == HAL_BUSY);
+
+	return BME280_forced_complete(dev, temp, press, hum, h);
+}
+
+HAL_StatusTypeDef BMP280_forced_measure(BMx280_t *dev, float *temp, float *press, float *h) {
+	HAL_StatusTypeDef status;
+
+	if ((status = BMx280_forced_start(dev)) != HAL_OK) {
 		return status;
 	}
+
+	while (BMx280_forced_poll(dev) == HAL_BUSY);
+
+	return BMP280_forced_complete(dev, temp, press, h);
+}
+
+HAL_StatusTypeDef BMx280_normal_measure(BMx280_t *dev) {
+	dev->sensor_settings.ctrl_meas = (dev->sensor_settings.ctrl_meas & 0xFC) | 0b11;
 	
-	uint8_t BMx_status = 1;
-	while (BMx_status >> 3 != 0) {
-		if ((status = I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_STATUS, &status, 1, 0xFF)) != HAL_OK) {
-			return status;
-		}
-	}
+	return I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CTRL_MEAS, &dev->sensor_settings.ctrl_meas, 1, 0xFF);
+}
+
+HAL_StatusTypeDef BMx280_sleep(BMx280_t *dev) {
+	dev->sensor_settings.ctrl_meas = (dev->sensor_settings.ctrl_meas & 0xFC) | 0b00;
+	
+	return I2C_Mem_Write(dev->hi2c, dev->address, BMx280_REGISTER_CTRL_MEAS, &dev->sensor_settings.ctrl_meas, 1, 0xFF);
+}
+
+HAL_StatusTypeDef BME280_get_measure(BMx280_t *dev, float *temp, float *press, float *hum, float *h) {
+	HAL_StatusTypeDef status;
 
 	uint8_t raw_data[8];
-	if ((status = I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_RAW_DATA, raw_data, 8, 0xFF)) != HAL_OK) {
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, 8, 0xFF)) != HAL_OK) {
 		return status;
 	}
-
+	
 	int32_t ADC_data[3];
-	for (int i = 0; i < 2; i++) {
-		ADC_data[i] = (int32_t)(((uint32_t)raw_data[3 * i + 0] << 12) | ((uint32_t)raw_data[3 * i + 1] << 4) | ((uint32_t)raw_data[3 * i + 2] >> 4));
+	__BMx280_unpack_raw(raw_data, &ADC_data[0], &ADC_data[1], &ADC_data[2]);
+	
+	*temp = __BMx280_compensate_T_int32(dev, ADC_data[1]) / 100.f;
+	*press = __BMx280_compensate_P_int64(dev, ADC_data[0]) / 256.f;
+	*hum = __BMx280_compensate_H_int32(dev, ADC_data[2]) / 1024.f;
+	*h = 29.254f * ((*temp) + 273.15f) * logf(dev->refPressure / (*press));
+	
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef BMP280_get_measure(BMx280_t *dev, float *temp, float *press, float *h) {
+	HAL_StatusTypeDef status;
+
+	uint8_t raw_data[6];
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, 6, 0xFF)) != HAL_OK) {
+		return status;
 	}
-	ADC_data[2] = (int32_t)(((uint16_t)raw_data[7] << 8) | ((uint16_t)raw_data[6] & 0xFF));
+
+	int32_t ADC_data[2];
+	__BMx280_unpack_raw(raw_data, &ADC_data[0], &ADC_data[1], NULL);
+
+	*temp = __BMx280_compensate_T_int32(dev, ADC_data[1]) / 100.f;
+	*press = __BMx280_compensate_P_int64(dev, ADC_data[0]) / 256.f;
+	*h = 29.254f * ((*temp) + 273.15f) * logf(dev->refPressure / (*press));
 	
-	*temp = __BMx280_compensate_T_int32(ADC_data[1]) / 100.;
-	*press = __BMx280_compensate_P_int64(ADC_data[0]) / 256.;
-	*hum = __BMx280_compensate_H_int32(ADC_data[2]) / 1024.;
-	*h = 29.254 * ((*temp) + 273.15) * log(BMx280_refPressure / (*press));
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef BMx280_get_raw_status(BMx280_t *dev, uint8_t *BMx_status, BMx280_raw_t *raw) {
+	HAL_StatusTypeDef status;
+
+	//!< 0xF3 - статус, 0xF4..0xF6 - ctrl_meas, config и резервный регистр, 0xF7..0xFE - данные АЦП
+	uint8_t buffer[12];
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_STATUS, buffer, 12, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	*BMx_status = buffer[0];
+	__BMx280_unpack_raw(&buffer[4], &raw->adc_P, &raw->adc_T, &raw->adc_H);
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef BMP280_forced_measure(float *temp, float *press, float *h) {
+HAL_StatusTypeDef BME280_get_measure_status(BMx280_t *dev, uint8_t *BMx_status, float *temp, float *press, float *hum, float *h) {
 	HAL_StatusTypeDef status;
 
-	BMx280_sensor_settings.ctrl_meas = (BMx280_sensor_settings.ctrl_meas & 0xFC) | 0b10;
-	
-	if ((status = HAL_I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_MEAS, I2C_MEMADD_SIZE_8BIT, (uint8_t*)&BMx280_sensor_settings.ctrl_meas, 1, 0xFF)) != HAL_OK) {
+	BMx280_raw_t raw;
+	if ((status = BMx280_get_raw_status(dev, BMx_status, &raw)) != HAL_OK) {
 		return status;
 	}
 
-	uint8_t status_of_measure = 1;
-	while (status_of_measure >> 3 != 0) {
-		if ((status = HAL_I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_STATUS, I2C_MEMADD_SIZE_8BIT, &status, 1, 0xFF)) != HAL_OK) {
-			return status;
-		}
+	//!< Новое измерение еще не записано в регистры - компенсацию не повторяем
+	uint8_t unchanged = dev->measure_valid && raw.adc_P == dev->raw.adc_P && raw.adc_T == dev->raw.adc_T && raw.adc_H == dev->raw.adc_H;
+
+	if (!unchanged) {
+		dev->raw = raw;
+		dev->measure[0] = __BMx280_compensate_T_int32(dev, raw.adc_T) / 100.f;
+		dev->measure[1] = __BMx280_compensate_P_int64(dev, raw.adc_P) / 256.f;
+		dev->measure[2] = __BMx280_compensate_H_int32(dev, raw.adc_H) / 1024.f;
+		dev->measure[3] = 29.254f * (dev->measure[0] + 273.15f) * logf(dev->refPressure / dev->measure[1]);
+		dev->measure_valid = 1;
+	}
+
+	*temp = dev->measure[0];
+	*press = dev->measure[1];
+	*hum = dev->measure[2];
+	*h = dev->measure[3];
+
+	return unchanged ? HAL_BUSY : HAL_OK;
+}
+
+HAL_StatusTypeDef BMP280_get_measure_status(BMx280_t *dev, uint8_t *BMx_status, float *temp, float *press, float *h) {
+	HAL_StatusTypeDef status;
+
+	BMx280_raw_t raw;
+	if ((status = BMx280_get_raw_status(dev, BMx_status, &raw)) != HAL_OK) {
+		return status;
+	}
+
+	uint8_t unchanged = dev->measure_valid && raw.adc_P == dev->raw.adc_P && raw.adc_T == dev->raw.adc_T;
+
+	if (!unchanged) {
+		dev->raw = raw;
+		dev->measure[0] = __BMx280_compensate_T_int32(dev, raw.adc_T) / 100.f;
+		dev->measure[1] = __BMx280_compensate_P_int64(dev, raw.adc_P) / 256.f;
+		dev->measure[3] = 29.254f * (dev->measure[0] + 273.15f) * logf(dev->refPressure / dev->measure[1]);
+		dev->measure_valid = 1;
 	}
 
+	*temp = dev->measure[0];
+	*press = dev->measure[1];
+	*h = dev->measure[3];
+
+	return unchanged ? HAL_BUSY : HAL_OK;
+}
+
+uint32_t __BMx280_compensate_P_Q24_8(BMx280_t *dev, int32_t adc_P);
+
+HAL_StatusTypeDef BMx280_get_altitude(BMx280_t *dev, int32_t *h) {
+	HAL_StatusTypeDef status;
+
 	uint8_t raw_data[6];
-	if ((status = HAL_I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_RAW_DATA, I2C_MEMADD_SIZE_8BIT, raw_data, 6, 0xFF)) != HAL_OK) {
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, 6, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	int32_t ADC_data[2];
-	for (int i = 0; i < 2; i++) {
-		ADC_data[i] = (int32_t)(((uint32_t)raw_data[3* i + 0] << 12) | ((uint32_t)raw_data[3 * i + 1] << 4) | ((uint32_t)raw_data[3 * i + 2] >> 4));
-	}
+	__BMx280_unpack_raw(raw_data, &ADC_data[0], &ADC_data[1], NULL);
+
+	int32_t temp = __BMx280_compensate_T_int32(dev, ADC_data[1]);
+	*h = BMx280_altitude(dev->refPressure, temp, __BMx280_compensate_P_Q24_8(dev, ADC_data[0]));
 
-	*temp = __BMx280_compensate_T_int32(ADC_data[1]) / 100.;
-	*press = __BMx280_compensate_P_int64(ADC_data[0]) / 256.;
-	*h = 29.254 * ((*temp) + 273.15) * log(BMx280_refPressure / (*press));
-	
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef BMx280_normal_measure() {
-	BMx280_sensor_settings.ctrl_meas = (BMx280_sensor_settings.ctrl_meas & 0xFC) | 0b11;
-	
-	return I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_MEAS, (uint8_t*)&BMx280_sensor_settings, 1, 0xFF);
+uint32_t __BMx280_compensate_P_Q24_8(BMx280_t *dev, int32_t adc_P) {
+#ifdef BMx280_PRESSURE_INT32
+	//!< 32-битная компенсация дает давление с точностью до 1 Па, переводим в тот же формат Q24.8
+	return __BMx280_compensate_P_int32(dev, adc_P) << 8;
+#else
+	return __BMx280_compensate_P_int64(dev, adc_P);
+#endif /* BMx280_PRESSURE_INT32 */
 }
 
-HAL_StatusTypeDef BMx280_sleep() {
-	BMx280_sensor_settings.ctrl_meas = (BMx280_sensor_settings.ctrl_meas & 0xFC) | 0b00;
-	
-	return I2C_Mem_Write(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_CTRL_MEAS, (uint8_t*)&BMx280_sensor_settings, 1, 0xFF);
+void BMx280_compensate_raw(BMx280_t *dev, const BMx280_raw_t *raw, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h) {
+	*temp = __BMx280_compensate_T_int32(dev, raw->adc_T);
+	*press = __BMx280_compensate_P_Q24_8(dev, raw->adc_P);
+	if (hum != NULL) {
+		*hum = (uint32_t)__BMx280_compensate_H_int32(dev, raw->adc_H);
+	}
+	*h = BMx280_altitude(dev->refPressure, *temp, *press);
+}
+
+void __BMx280_compensate_int(BMx280_t *dev, uint8_t *raw_data, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h) {
+	BMx280_raw_t raw;
+	__BMx280_unpack_raw(raw_data, &raw.adc_P, &raw.adc_T, hum != NULL ? &raw.adc_H : NULL);
+
+	BMx280_compensate_raw(dev, &raw, temp, press, hum, h);
 }
 
-HAL_StatusTypeDef BME280_get_measure(float *temp, float *press, float *hum, float *h) {
+HAL_StatusTypeDef BME280_get_measure_int(BMx280_t *dev, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h) {
 	HAL_StatusTypeDef status;
 
 	uint8_t raw_data[8];
-	if ((status = I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_RAW_DATA, raw_data, 8, 0xFF)) != HAL_OK) {
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, 8, 0xFF)) != HAL_OK) {
 		return status;
 	}
-	
-	int32_t ADC_data[3];
-	for (int i = 0; i < 2; i++) {
-		ADC_data[i] = (int32_t)(((uint32_t)raw_data[3 * i + 0] << 12) | ((uint32_t)raw_data[3 * i + 1] << 4) | ((uint32_t)raw_data[3 * i + 2] >> 4));
-	}
-	ADC_data[2] = (int32_t)(((uint16_t)raw_data[7] << 8) | ((uint16_t)raw_data[6] & 0xFF));
-	
-	*temp = __BMx280_compensate_T_int32(ADC_data[1]) / 100.;
-	*press = __BMx280_compensate_P_int64(ADC_data[0]) / 256.;
-	*hum = __BMx280_compensate_H_int32(ADC_data[2]) / 1024.;
-	*h = 29.254 * ((*temp) + 273.15) * log(BMx280_refPressure / (*press));
-	
+
+	__BMx280_compensate_int(dev, raw_data, temp, press, hum, h);
+
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef BMP280_get_measure(float *temp, float *press, float *h) {
+HAL_StatusTypeDef BMP280_get_measure_int(BMx280_t *dev, int32_t *temp, uint32_t *press, int32_t *h) {
 	HAL_StatusTypeDef status;
 
 	uint8_t raw_data[6];
-	if ((status = HAL_I2C_Mem_Read(BMx280_hi2c, BMx280_ADDRESS, BMx280_REGISTER_RAW_DATA, I2C_MEMADD_SIZE_8BIT, raw_data, 6, 0xFF)) != HAL_OK) {
+	if ((status = I2C_Mem_Read(dev->hi2c, dev->address, BMx280_REGISTER_RAW_DATA, raw_data, 6, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
-	int32_t ADC_data[2];
-	for (int i = 0; i < 2; i++) {
-		ADC_data[i] = (int32_t)(((uint32_t)raw_data[3 * i + 0] << 12) | ((uint32_t)raw_data[3 * i + 1] << 4) | ((uint32_t)raw_data[3 * i + 2] >> 4));
+	__BMx280_compensate_int(dev, raw_data, temp, press, NULL, h);
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef BME280_forced_complete_int(BMx280_t *dev, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h) {
+	HAL_StatusTypeDef status;
+
+	uint8_t raw_data[8];
+	if ((status = __BMx280_forced_read(dev, raw_data, 8)) != HAL_OK) {
+		return status;
 	}
 
-	*temp = __BMx280_compensate_T_int32(ADC_data[0]) / 100.;
-	*press = __BMx280_compensate_P_int64(ADC_data[1]) / 256.;
-	*h = 29.254 * ((*temp) + 273.15) * log(BMx280_refPressure / (*press));
-	
+	__BMx280_compensate_int(dev, raw_data, temp, press, hum, h);
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef BMP280_forced_complete_int(BMx280_t *dev, int32_t *temp, uint32_t *press, int32_t *h) {
+	HAL_StatusTypeDef status;
+
+	uint8_t raw_data[6];
+	if ((status = __BMx280_forced_read(dev, raw_data, 6)) != HAL_OK) {
+		return status;
+	}
+
+	__BMx280_compensate_int(dev, raw_data, temp, press, NULL, h);
+
 	return HAL_OK;
 }
+
+void BMx280_save(BMx280_t *dev, BMx280_snapshot_t *snapshot) {
+	memset(snapshot, 0, sizeof(BMx280_snapshot_t));
+
+	snapshot->calibration_data = dev->calibration_data;
+	snapshot->sensor_settings = dev->sensor_settings;
+	snapshot->refPressure = dev->refPressure;
+	snapshot->measure_time = dev->measure_time;
+
+	Snapshot_seal(snapshot, sizeof(BMx280_snapshot_t), dev->id, dev->address);
+}
+
+HAL_StatusTypeDef BMx280_restore(BMx280_t *dev, BMx280_BUS_TypeDef *hi2c_, const BMx280_snapshot_t *snapshot) {
+	HAL_StatusTypeDef status;
+
+	uint8_t id = 0;
+
+	if ((status = I2C_Mem_Read(hi2c_, snapshot->header.address, BMx280_REGISTER_ID, &id, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if (!Snapshot_check(snapshot, sizeof(BMx280_snapshot_t), id)) {
+		return HAL_ERROR;
+	}
+
+	dev->hi2c = hi2c_;
+	dev->address = snapshot->header.address;
+	dev->id = id;
+	dev->refPressure = snapshot->refPressure;
+	dev->t_fine = 0;
+	dev->calibration_data = snapshot->calibration_data;
+	dev->sensor_settings = snapshot->sensor_settings;
+	dev->measure_time = snapshot->measure_time;
+	dev->measure_pending = 0;
+	dev->measure_valid = 0;
+
+	return __BMx280_write_settings(dev);
+}
+
+#ifdef BMx280_SPI
+HAL_StatusTypeDef BMx280_SPI_Mem_Read(BMx280_spi_t *bus, uint8_t reg, uint8_t *buffer, uint16_t size, uint32_t timeout) {
+	HAL_StatusTypeDef status;
+
+	//!< Бит 7 адреса - чтение. CS опускается и поднимается записью в BSRR, одинаково для HAL и LL
+	reg |= 0x80;
+	bus->cs_port->BSRR = (uint32_t)bus->cs_pin << 16;
+
+	if ((status = BMx280_SPI_Transmit(bus->hspi, &reg, 1, timeout)) == HAL_OK) {
+		status = BMx280_SPI_Receive(bus->hspi, buffer, size, timeout);
+	}
+
+	bus->cs_port->BSRR = bus->cs_pin;
+
+	return status;
+}
+
+HAL_StatusTypeDef BMx280_SPI_Mem_Write(BMx280_spi_t *bus, uint8_t reg, uint8_t *buffer, uint16_t size, uint32_t timeout) {
+	HAL_StatusTypeDef status = HAL_OK;
+
+	uint8_t pair[2];
+
+	bus->cs_port->BSRR = (uint32_t)bus->cs_pin << 16;
+
+	for (uint16_t i = 0; i < size && status == HAL_OK; i++) {
+		pair[0] = (reg + i) & 0x7F;
+		pair[1] = buffer[i];
+		status = BMx280_SPI_Transmit(bus->hspi, pair, 2, timeout);
+	}
+
+	bus->cs_port->BSRR = bus->cs_pin;
+
+	return status;
+}
+#endif /* BMx280_SPI */
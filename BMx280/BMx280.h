@@ -16,46 +16,151 @@
 #define BMx280_H_
 
 #include "main.h"
+#include "BMx280_compensate.h"
+#include "Snapshot.h"
+
+/**
+ * @name Макрос выбора целочисленной компенсации давления
+ * @{
+ */
+//#define BMx280_PRESSURE_INT32 			//!< Определите, чтобы целочисленные функции использовали 32-битную компенсацию давления (точность 1 Па, без 64-битной арифметики)
+/** @} */
+
+/**
+ * @name Макрос выбора шины
+ * @details По умолчанию датчик подключается по I2C. При определенном BMx280_SPI все функции библиотеки, включая инициализацию
+ * 	и чтение калибровки, работают через SPI: вместо экземпляра I2C передается указатель на @ref BMx280_spi_t,
+ * 	адрес датчика игнорируется. Библиотека STM32 по-прежнему выбирается макросом BMx280_HAL или BMx280_LL.
+ *
+ * 	Чтение 8 байт данных по I2C 400 кГц занимает около 12 байт на шине (адрес, регистр, повторный старт, данные) по 9 бит - ~270 мкс.
+ * 	По SPI 10 МГц те же данные передаются за 9 байт по 8 бит - ~7 мкс.
+ * @{
+ */
+//#define BMx280_SPI						//!< Определите для подключения датчика по SPI (режим 0 или 3, до 10 МГц)
+/** @} */
 
 /** @cond UNNECESSARY */
 #ifdef BMx280_HAL
 #define I2C_TypeDef 		I2C_HandleTypeDef
 #define I2C_Mem_Write(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)		HAL_I2C_Mem_Write(ADR,DEV_ADR,REG_ADR,I2C_MEMADD_SIZE_8BIT,BUF,BUF_SIZE,TIMEOUT)
 #define I2C_Mem_Read(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)			HAL_I2C_Mem_Read(ADR,DEV_ADR,REG_ADR,I2C_MEMADD_SIZE_8BIT,BUF,BUF_SIZE,TIMEOUT)
+#define BMx280_SPI_Handle	SPI_HandleTypeDef
+#define BMx280_SPI_Transmit(SPI, BUF, BUF_SIZE, TIMEOUT)					HAL_SPI_Transmit(SPI,BUF,BUF_SIZE,TIMEOUT)
+#define BMx280_SPI_Receive(SPI, BUF, BUF_SIZE, TIMEOUT)						HAL_SPI_Receive(SPI,BUF,BUF_SIZE,TIMEOUT)
 
 #elif BMx280_LL
 #include "I2C_ll.h"
+#ifdef BMx280_SPI
+#include "SPI_ll.h"
+#endif /* BMx280_SPI */
 #define I2C_TypeDef 		I2C_TypeDef
 #define I2C_Mem_Write(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)		LL_I2C_Mem_Write(ADR,DEV_ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
 #define I2C_Mem_Read(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)			LL_I2C_Mem_Read(ADR,DEV_ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
+#define BMx280_SPI_Handle	SPI_TypeDef
+#define BMx280_SPI_Transmit(SPI, BUF, BUF_SIZE, TIMEOUT)					LL_SPI_Transmit(SPI,BUF,BUF_SIZE,TIMEOUT)
+#define BMx280_SPI_Receive(SPI, BUF, BUF_SIZE, TIMEOUT)						LL_SPI_Receive(SPI,BUF,BUF_SIZE,TIMEOUT)
 #endif /** BMx280_LL */
+/** @endcond */
 
-/* Calibration data for temperature and pressure */
+#ifdef BMx280_SPI
+/**
+ * @brief Подключение датчика по SPI
+ * @ingroup BMx280
+ * @details Используется при определенном BMx280_SPI вместо экземпляра I2C. Вывод CS управляется библиотекой.
+ */
 typedef struct {
-	uint16_t dig_T1;
-	int16_t dig_T2;
-	int16_t dig_T3;
-	uint16_t dig_P1;
-	int16_t dig_P2;
-	int16_t dig_P3;
-	int16_t dig_P4;
-	int16_t dig_P5;
-	int16_t dig_P6;
-	int16_t dig_P7;
-	int16_t dig_P8;
-	int16_t dig_P9;
-	uint8_t dig_H1;
-	int16_t dig_H2;
-	uint8_t dig_H3;
-	int16_t dig_H4;
-	int16_t dig_H5;
-	int8_t dig_H6;
-} BMx280_calibration_data;
+	BMx280_SPI_Handle *hspi;					//!< Экземпляр интерфейса SPI
+	GPIO_TypeDef *cs_port;						//!< Порт вывода CS
+	uint16_t cs_pin;							//!< Маска вывода CS (GPIO_PIN_x)
+} BMx280_spi_t;
+
+/** @cond UNNECESSARY */
+#define BMx280_BUS_TypeDef	BMx280_spi_t
+#undef I2C_Mem_Write
+#undef I2C_Mem_Read
+#define I2C_Mem_Write(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)		BMx280_SPI_Mem_Write(ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
+#define I2C_Mem_Read(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)			BMx280_SPI_Mem_Read(ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
+/** @endcond */
+#else
+/** @cond UNNECESSARY */
+#define BMx280_BUS_TypeDef	I2C_TypeDef
 /** @endcond */
+#endif /* BMx280_SPI */
 
-extern uint32_t BMx280_refPressure; //!< Давление при инициализации датчика для вычисления высоты
+/**
+ * @brief Копия регистров конфигурации датчика
+ * @ingroup BMx280
+ * @details Каждый регистр записывается отдельной транзакцией: при записи по I2C адрес регистра не увеличивается.
+ */
+typedef struct {
+	uint8_t ctrl_meas;							//!< Регистр ctrl_meas (0xF4)
+	uint8_t config;								//!< Регистр config (0xF5)
+	uint8_t ctrl_hum;							//!< Регистр ctrl_hum (0xF2)
+} BMx280_settings;
+
+/**
+ * @brief Необработанные данные АЦП датчика
+ * @ingroup BMx280
+ */
+typedef struct {
+	int32_t adc_P;								//!< Давление, 20 бит
+	int32_t adc_T;								//!< Температура, 20 бит
+	int32_t adc_H;								//!< Влажность, 16 бит (только BME280)
+} BMx280_raw_t;
+
+/**
+ * @brief Экземпляр датчика BMP/BME280
+ * @ingroup BMx280
+ * @details Хранит все состояние датчика: интерфейс, адрес, калибровочные коэффициенты и текущие настройки.
+ *  Несколько экземпляров не разделяют общих данных, поэтому два датчика на одной шине (0x76 и 0x77)
+ *  можно опрашивать поочередно без повторной инициализации.
+ */
+typedef struct {
+	BMx280_BUS_TypeDef *hi2c;					//!< Экземпляр интерфейса I2C (или @ref BMx280_spi_t при BMx280_SPI), к которому подключен датчик
+	uint16_t address;							//!< Адрес датчика на шине I2C
+	uint8_t id;									//!< Идентификатор датчика: 0x60 для BME280, 0x58 для BMP280
+	uint32_t refPressure;						//!< Давление, относительно которого вычисляется высота
+	int32_t t_fine;								//!< Промежуточное значение температуры для компенсации давления и влажности
+	BMx280_calibration_data calibration_data;	//!< Калибровочные коэффициенты, считанные из памяти датчика
+	BMx280_settings sensor_settings;			//!< Копия регистров конфигурации датчика
+	uint32_t measure_time;						//!< Максимальное время одного измерения в мкс, вычисленное по текущей конфигурации
+	uint32_t measure_start;						//!< Время запуска разового измерения в мс (HAL_GetTick)
+	uint8_t measure_pending;					//!< Запущено разовое измерение, результат которого еще не прочитан
+	BMx280_raw_t raw;							//!< Последние прочитанные данные АЦП
+	float measure[4];							//!< Результат компенсации последних данных: температура, давление, влажность, высота
+	uint8_t measure_valid;						//!< Поле measure соответствует полю raw
+} BMx280_t;
 
-extern I2C_TypeDef *BMx280_hi2c;  //!< Экземпляр интерфейса I2C, к которому подключен BMP280/BME280
+/**
+ * @brief Снимок состояния датчика для восстановления после сброса МК
+ * @ingroup BMx280
+ * @details Содержит все, что @ref BMx280_init считывает из датчика, и текущую конфигурацию.
+ * 	Заполняется функцией @ref BMx280_save, хранится в резервной памяти или flash (см. @ref Snapshot).
+ */
+typedef struct {
+	Snapshot_header_t header;					//!< Заголовок с идентификатором датчика, адресом и CRC
+	BMx280_calibration_data calibration_data;	//!< Калибровочные коэффициенты
+	BMx280_settings sensor_settings;			//!< Копия регистров конфигурации
+	uint32_t refPressure;						//!< Давление, относительно которого вычисляется высота
+	uint32_t measure_time;						//!< Время одного измерения в мкс
+} BMx280_snapshot_t;
+
+/**
+ * @name Биты регистра статуса
+ * @{
+ */
+#define BMx280_STATUS_MEASURING			0b1000		//!< Идет измерение
+#define BMx280_STATUS_IM_UPDATE			0b0001		//!< Идет копирование калибровочных данных из NVM
+/** @} */
+
+/**
+ * @name Адреса датчика на шине I2C
+ * @{
+ */
+#define BMx280_ADDRESS_AUTO				0x00		//!< Автоматическое определение адреса по SDO
+#define BMx280_ADDRESS_0				(0x76 << 1)	//!< SDO подключен к GND
+#define BMx280_ADDRESS_1				(0x77 << 1)	//!< SDO подключен к VDDIO
+/** @} */
 
 /**
  * @defgroup STANDBY_MODE
@@ -120,8 +225,8 @@ extern I2C_TypeDef *BMx280_hi2c;  //!< Экземпляр интерфейса I
 
 /** @cond UNNECESSARY */
 #define BMx280_REGISTER_CALIBRATION		0x88
-#define BMx280_REGISTER_CALIBRATION_H4	0xE4
-#define BMx280_REGISTER_CALIBRATION_H6	0xE7
+#define BMx280_REGISTER_CALIBRATION_H1	0xA1
+#define BMx280_REGISTER_CALIBRATION_H2	0xE1
 #define BMx280_REGISTER_RAW_DATA 		0xF7
 #define BMx280_REGISTER_CONFIG 			0xF5
 #define BMx280_REGISTER_CTRL_MEAS 		0xF4
@@ -135,14 +240,16 @@ extern I2C_TypeDef *BMx280_hi2c;  //!< Экземпляр интерфейса I
 /**
  * @brief Инициализация BME/BMP280 
  * @ingroup BMx280
- * @note Автоматически определяет адрес датчика в зависимости от SDO. 
- * 	Данная библиотека поддерживает только один подключенный датчик BMP/BME280
+ * @note При адресе @ref BMx280_ADDRESS_AUTO адрес датчика определяется автоматически в зависимости от SDO. 
+ * 	Для работы с двумя датчиками на одной шине адрес каждого указывается явно.
  *
- * @param[in] hi2c_ Экземляр интерфейса I2C, к которому подключен датчик
+ * @param[out] dev Экземпляр датчика
+ * @param[in] hi2c_ Экземляр интерфейса I2C (или @ref BMx280_spi_t при BMx280_SPI), к которому подключен датчик
+ * @param[in] address Адрес датчика: @ref BMx280_ADDRESS_0, @ref BMx280_ADDRESS_1 или @ref BMx280_ADDRESS_AUTO
  * @param[in] refPressure_ Начальное давление, относительно которого вычисляется высота по давлению 
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BMx280_init(I2C_TypeDef *hi2c_, uint32_t refPressure_);
+HAL_StatusTypeDef BMx280_init(BMx280_t *dev, BMx280_BUS_TypeDef *hi2c_, uint16_t address, uint32_t refPressure_);
 
 /**
  * @brief Конфигурация датчика BMP/BME280 
@@ -152,6 +259,7 @@ HAL_StatusTypeDef BMx280_init(I2C_TypeDef *hi2c_, uint32_t refPressure_);
  * 
  * @note Конфигурация датчика влажности актуальна только для BME280. BMP280 не имеет датчика влажности.
  * 
+ * @param [in,out] dev Экземпляр датчика
  * @param [in] T_OS OVERSAMPLING для термометра. Допустимые значения см. в @ref OVERSAMPLING 
  * @param [in] P_OS OVERSAMPLING для барометра. Допустимые значения см. в @ref OVERSAMPLING 
  * @param [in] H_OS OVERSAMPLING для гигрометра. Допустимые значения см. в @ref OVERSAMPLING 
@@ -159,22 +267,25 @@ HAL_StatusTypeDef BMx280_init(I2C_TypeDef *hi2c_, uint32_t refPressure_);
  * @param [in] IIRF Коэффициент сглаживания для IIR-фильтра. Допустимые значения см. в @ref IIR_FILTER
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BMx280_config(uint8_t T_OS, uint8_t P_OS, uint8_t H_OS, uint8_t STDB, uint8_t IIRF);
+HAL_StatusTypeDef BMx280_config(BMx280_t *dev, uint8_t T_OS, uint8_t P_OS, uint8_t H_OS, uint8_t STDB, uint8_t IIRF);
 
 /**
  * @brief Функция для разового измерения и чтения данных с датчика BME280.
  * @ingroup BMx280
- * @details Высота вычисляется по формуле @f$ 29.254 \cdot (T + 273.15) \cdot \log(\frac{pres_{ref}}{pres})@f$
+ * @details Запускает измерение и ждет его окончания по времени, вычисленному из конфигурации, без опроса регистра статуса.
+ * 	Для работы без ожидания используются @ref BMx280_forced_start и @ref BME280_forced_complete.  
+ * 	Высота вычисляется по формуле @f$ 29.254 \cdot (T + 273.15) \cdot \log(\frac{pres_{ref}}{pres})@f$
  * 
  * @note Функции измерения данных не универсальны для датчиков BMP/BME280.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] temp Измеренная температура в градусах Цельсия
  * @param[out] press Измеренное давление в Паскалях
  * @param[out] hum Измеренная влажность в %
  * @param[out] h Вычисленная высота в метрах
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BME280_forced_measure(float *temp, float *press, float *hum, float *h);
+HAL_StatusTypeDef BME280_forced_measure(BMx280_t *dev, float *temp, float *press, float *hum, float *h);
 /**
  * @brief Чтение измеренных данных из памяти BME280
  * @ingroup BMx280
@@ -183,28 +294,32 @@ HAL_StatusTypeDef BME280_forced_measure(float *temp, float *press, float *hum, f
  * 
  * @note Функции чтения данных не универсальны для датчиков BMP/BME280.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] temp Измеренная температура в градусах Цельсия
  * @param[out] press Измеренное давление в Паскалях
  * @param[out] hum Измеренная влажность в %
  * @param[out] h Вычисленная высота в метрах
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BME280_get_measure(float *temp, float *press, float *hum, float *h);
+HAL_StatusTypeDef BME280_get_measure(BMx280_t *dev, float *temp, float *press, float *hum, float *h);
 
 /**
  * @brief Функция для разового измерения и чтения данных с датчика BMP280.
  * @ingroup BMx280
- * @details Высота вычисляется по формуле @f$ 29.254 \cdot (T + 273.15) \cdot \log(\frac{pres_{ref}}{pres})@f$
+ * @details Запускает измерение и ждет его окончания по времени, вычисленному из конфигурации, без опроса регистра статуса.
+ * 	Для работы без ожидания используются @ref BMx280_forced_start и @ref BMP280_forced_complete.  
+ * 	Высота вычисляется по формуле @f$ 29.254 \cdot (T + 273.15) \cdot \log(\frac{pres_{ref}}{pres})@f$
  * 
  * @note Функции измерения данных не универсальны для датчиков BMP/BME280.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] temp Измеренная температура в градусах Цельсия
  * @param[out] press Измеренное давление в Паскалях
  * @param[out] h Вычисленная высота в метрах
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
 
-HAL_StatusTypeDef BMP280_forced_measure(float *temp, float *press, float *h);
+HAL_StatusTypeDef BMP280_forced_measure(BMx280_t *dev, float *temp, float *press, float *h);
 /**
  * @brief Чтение измеренных данных из памяти BMP280
  * @ingroup BMx280
@@ -213,20 +328,22 @@ HAL_StatusTypeDef BMP280_forced_measure(float *temp, float *press, float *h);
  * 
  * @note Функции чтения данных не универсальны для датчиков BMP/BME280.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] temp Измеренная температура в градусах Цельсия
  * @param[out] press Измеренное давление в Паскалях
  * @param[out] h Вычисленная высота в метрах
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BMP280_get_measure(float *temp, float *press, float *h);
+HAL_StatusTypeDef BMP280_get_measure(BMx280_t *dev, float *temp, float *press, float *h);
 
 /**
  * @brief Переход в режим сна
  * @ingroup BMx280
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BMx280_sleep();
+HAL_StatusTypeDef BMx280_sleep(BMx280_t *dev);
 /**
  * @brief Переход в режим измерений. 
  * @ingroup BMx280
@@ -234,8 +351,269 @@ HAL_StatusTypeDef BMx280_sleep();
  * 	Измерения записывает во внутреннюю память, которые можно считать функцией @ref BMP280_get_measure или 
  *  @ref BME280_get_measure.
  * 
+ * @param[in,out] dev Экземпляр датчика
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef BMx280_normal_measure(BMx280_t *dev);
+
+/**
+ * @brief Максимальное время одного измерения
+ * @ingroup BMx280
+ * @details Вычисляется при конфигурации по формуле из документации на датчик:  
+ * 	@f$ t = 1.25 + 2.3 \cdot T_{os} + (2.3 \cdot P_{os} + 0.575) + (2.3 \cdot H_{os} + 0.575) @f$ мс,
+ * 	где @f$ T_{os}, P_{os}, H_{os} @f$ - количество выборок OVERSAMPLING. Слагаемое отключенного датчика не учитывается.
+ *
+ * @param[in] dev Экземпляр датчика
+ * @return uint32_t Время измерения в мкс
+ */
+uint32_t BMx280_get_measure_time(BMx280_t *dev);
+
+/**
+ * @brief Период измерений в режиме normal
+ * @ingroup BMx280
+ * @details Сумма типового времени измерения @f$ 1 + 2 \cdot T_{os} + (2 \cdot P_{os} + 0.5) + (2 \cdot H_{os} + 0.5) @f$ мс
+ * 	и времени ожидания из @ref STANDBY_MODE. У BME280 значения 0b110 и 0b111 означают 10 и 20 мс, у BMP280 - 2 и 4 с.
+ *
+ * @param[in] dev Экземпляр датчика
+ * @return uint32_t Период измерений в мкс
+ */
+uint32_t BMx280_get_period(BMx280_t *dev);
+
+/**
+ * @brief Запуск разового измерения без ожидания
+ * @ingroup BMx280
+ * @details Переводит датчик в режим forced и запоминает время запуска. Функция сразу возвращает управление,
+ * 	результат читается функцией @ref BME280_forced_complete или @ref BMP280_forced_complete.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @return HAL_StatusTypeDef Результат отправки данных по I2C
+ */
+HAL_StatusTypeDef BMx280_forced_start(BMx280_t *dev);
+
+/**
+ * @brief Проверка готовности разового измерения
+ * @ingroup BMx280
+ * @details Сравнивает прошедшее время с @ref BMx280_get_measure_time. Обращений к шине I2C не выполняет.
+ *
+ * @param[in] dev Экземпляр датчика
+ * @retval HAL_OK Результат измерения готов
+ * @retval HAL_BUSY Измерение еще идет
+ * @retval HAL_ERROR Измерение не было запущено
+ */
+HAL_StatusTypeDef BMx280_forced_poll(BMx280_t *dev);
+
+/**
+ * @brief Чтение результата разового измерения BME280
+ * @ingroup BMx280
+ * @details Если результат еще не готов, возвращает HAL_BUSY без обращения к шине. Иначе однократно читает данные.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Измеренная температура в градусах Цельсия
+ * @param[out] press Измеренное давление в Паскалях
+ * @param[out] hum Измеренная влажность в %
+ * @param[out] h Вычисленная высота в метрах
+ * @return HAL_StatusTypeDef Результат получения данных по I2C или результат @ref BMx280_forced_poll
+ */
+HAL_StatusTypeDef BME280_forced_complete(BMx280_t *dev, float *temp, float *press, float *hum, float *h);
+
+/**
+ * @brief Чтение результата разового измерения BMP280
+ * @ingroup BMx280
+ * @details Если результат еще не готов, возвращает HAL_BUSY без обращения к шине. Иначе однократно читает данные.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Измеренная температура в градусах Цельсия
+ * @param[out] press Измеренное давление в Паскалях
+ * @param[out] h Вычисленная высота в метрах
+ * @return HAL_StatusTypeDef Результат получения данных по I2C или результат @ref BMx280_forced_poll
+ */
+HAL_StatusTypeDef BMP280_forced_complete(BMx280_t *dev, float *temp, float *press, float *h);
+
+/**
+ * @brief Чтение регистра статуса и данных АЦП одной транзакцией
+ * @ingroup BMx280
+ * @details Читает регистры 0xF3..0xFE за одно обращение к шине: регистр статуса и данные АЦП.
+ *
+ * @param[in] dev Экземпляр датчика
+ * @param[out] BMx_status Значение регистра статуса. Биты см. в @ref BMx280_STATUS_MEASURING, @ref BMx280_STATUS_IM_UPDATE
+ * @param[out] raw Данные АЦП
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef BMx280_normal_measure();
+HAL_StatusTypeDef BMx280_get_raw_status(BMx280_t *dev, uint8_t *BMx_status, BMx280_raw_t *raw);
+
+/**
+ * @brief Чтение статуса и измеренных данных BME280 одной транзакцией
+ * @ingroup BMx280
+ * @details Аналог @ref BME280_get_measure, дополнительно возвращающий регистр статуса без отдельного обращения к шине.
+ * 	Если данные АЦП не изменились с прошлого чтения, компенсация не выполняется и возвращается прошлый результат.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] BMx_status Значение регистра статуса
+ * @param[out] temp Измеренная температура в градусах Цельсия
+ * @param[out] press Измеренное давление в Паскалях
+ * @param[out] hum Измеренная влажность в %
+ * @param[out] h Вычисленная высота в метрах
+ * @retval HAL_OK Получены новые данные
+ * @retval HAL_BUSY Данные не изменились с прошлого чтения, возвращен прошлый результат
+ * @retval HAL_ERROR Ошибка получения данных по I2C
+ */
+HAL_StatusTypeDef BME280_get_measure_status(BMx280_t *dev, uint8_t *BMx_status, float *temp, float *press, float *hum, float *h);
+
+/**
+ * @brief Чтение статуса и измеренных данных BMP280 одной транзакцией
+ * @ingroup BMx280
+ * @details Аналог @ref BMP280_get_measure, дополнительно возвращающий регистр статуса без отдельного обращения к шине.
+ * 	Если данные АЦП не изменились с прошлого чтения, компенсация не выполняется и возвращается прошлый результат.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] BMx_status Значение регистра статуса
+ * @param[out] temp Измеренная температура в градусах Цельсия
+ * @param[out] press Измеренное давление в Паскалях
+ * @param[out] h Вычисленная высота в метрах
+ * @retval HAL_OK Получены новые данные
+ * @retval HAL_BUSY Данные не изменились с прошлого чтения, возвращен прошлый результат
+ * @retval HAL_ERROR Ошибка получения данных по I2C
+ */
+HAL_StatusTypeDef BMP280_get_measure_status(BMx280_t *dev, uint8_t *BMx_status, float *temp, float *press, float *h);
+
+/**
+ * @brief Чтение высоты в мм без вычислений с плавающей точкой
+ * @ingroup BMx280
+ * @details Читает данные температуры и давления, компенсирует их целочисленными функциями и вычисляет высоту функцией
+ * 	@ref BMx280_altitude. Подходит для BMP280 и BME280.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] h Высота в мм относительно давления, заданного при инициализации
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef BMx280_get_altitude(BMx280_t *dev, int32_t *h);
+
+/**
+ * @brief Чтение измеренных данных из памяти BME280 без вычислений с плавающей точкой
+ * @ingroup BMx280
+ * @details Аналог @ref BME280_get_measure, возвращающий результат целочисленной компенсации без перевода в float.  
+ * 	Высота вычисляется функцией @ref BMx280_altitude.
+ * 	При определенном макросе @ref BMx280_PRESSURE_INT32 давление компенсируется 32-битной функцией и имеет нулевую дробную часть.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8 (24 бита целой части, 8 бит дробной)
+ * @param[out] hum Влажность в % в формате Q22.10 (22 бита целой части, 10 бит дробной)
+ * @param[out] h Высота в мм
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef BME280_get_measure_int(BMx280_t *dev, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h);
+
+/**
+ * @brief Чтение измеренных данных из памяти BMP280 без вычислений с плавающей точкой
+ * @ingroup BMx280
+ * @details Аналог @ref BMP280_get_measure, возвращающий результат целочисленной компенсации без перевода в float.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8
+ * @param[out] h Высота в мм
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef BMP280_get_measure_int(BMx280_t *dev, int32_t *temp, uint32_t *press, int32_t *h);
+
+/**
+ * @brief Чтение результата разового измерения BME280 без вычислений с плавающей точкой
+ * @ingroup BMx280
+ * @details Аналог @ref BME280_forced_complete с форматом результата @ref BME280_get_measure_int.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8
+ * @param[out] hum Влажность в % в формате Q22.10
+ * @param[out] h Высота в мм
+ * @return HAL_StatusTypeDef Результат получения данных по I2C или результат @ref BMx280_forced_poll
+ */
+HAL_StatusTypeDef BME280_forced_complete_int(BMx280_t *dev, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h);
+
+/**
+ * @brief Чтение результата разового измерения BMP280 без вычислений с плавающей точкой
+ * @ingroup BMx280
+ * @details Аналог @ref BMP280_forced_complete с форматом результата @ref BMP280_get_measure_int.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8
+ * @param[out] h Высота в мм
+ * @return HAL_StatusTypeDef Результат получения данных по I2C или результат @ref BMx280_forced_poll
+ */
+HAL_StatusTypeDef BMP280_forced_complete_int(BMx280_t *dev, int32_t *temp, uint32_t *press, int32_t *h);
+
+/**
+ * @brief Сохранение состояния датчика в снимок
+ * @ingroup BMx280
+ * @details Обращений к шине нет. Снимок затем копируется в резервную память или записывается
+ * 	во flash функцией @ref Snapshot_write_flash.
+ *
+ * @param[in] dev Инициализированный экземпляр датчика
+ * @param[out] snapshot Снимок
+ */
+void BMx280_save(BMx280_t *dev, BMx280_snapshot_t *snapshot);
+
+/**
+ * @brief Восстановление экземпляра датчика из снимка
+ * @ingroup BMx280
+ * @details Вместо полной инициализации выполняется одно чтение идентификатора по адресу из снимка.
+ * 	Если идентификатор и CRC снимка совпали, состояние экземпляра восстанавливается из снимка без чтения калибровки,
+ * 	а конфигурация записывается в датчик повторно, так как при просадке питания он мог сброситься.
+ *
+ * @param[out] dev Экземпляр датчика
+ * @param[in] hi2c_ Экземляр интерфейса I2C (или @ref BMx280_spi_t при BMx280_SPI), к которому подключен датчик
+ * @param[in] snapshot Снимок, сохраненный @ref BMx280_save
+ * @return HAL_StatusTypeDef Результат обмена по I2C. HAL_ERROR, если снимок поврежден или не соответствует датчику.
+ * 	В этом случае нужна полная инициализация @ref BMx280_init
+ */
+HAL_StatusTypeDef BMx280_restore(BMx280_t *dev, BMx280_BUS_TypeDef *hi2c_, const BMx280_snapshot_t *snapshot);
+
+/**
+ * @brief Целочисленная компенсация данных АЦП
+ * @ingroup BMx280
+ * @details Результат в формате @ref BME280_get_measure_int. Обращений к шине нет.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] raw Данные АЦП
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8
+ * @param[out] hum Влажность в % в формате Q22.10. NULL для BMP280
+ * @param[out] h Высота в мм
+ */
+void BMx280_compensate_raw(BMx280_t *dev, const BMx280_raw_t *raw, int32_t *temp, uint32_t *press, uint32_t *hum, int32_t *h);
+
+#ifdef BMx280_SPI
+/**
+ * @brief Чтение регистров датчика по SPI
+ * @ingroup BMx280
+ * @details В байте адреса устанавливается бит 7 (чтение), адрес регистра автоматически увеличивается датчиком.
+ * 	Используется библиотекой вместо I2C_Mem_Read при определенном BMx280_SPI.
+ *
+ * @param[in] bus Подключение датчика по SPI
+ * @param[in] reg Адрес первого регистра
+ * @param[out] buffer Буфер для прочитанных данных
+ * @param[in] size Количество байт
+ * @param[in] timeout Время ожидания в мс
+ * @return HAL_StatusTypeDef Результат обмена по SPI
+ */
+HAL_StatusTypeDef BMx280_SPI_Mem_Read(BMx280_spi_t *bus, uint8_t reg, uint8_t *buffer, uint16_t size, uint32_t timeout);
+
+/**
+ * @brief Запись регистров датчика по SPI
+ * @ingroup BMx280
+ * @details При записи по SPI датчик не увеличивает адрес, поэтому каждый байт передается парой
+ * 	"адрес со сброшенным битом 7, данные" в рамках одного выбора CS.
+ *
+ * @param[in] bus Подключение датчика по SPI
+ * @param[in] reg Адрес первого регистра
+ * @param[in] buffer Записываемые данные
+ * @param[in] size Количество байт
+ * @param[in] timeout Время ожидания в мс
+ * @return HAL_StatusTypeDef Результат обмена по SPI
+ */
+HAL_StatusTypeDef BMx280_SPI_Mem_Write(BMx280_spi_t *bus, uint8_t reg, uint8_t *buffer, uint16_t size, uint32_t timeout);
+#endif /* BMx280_SPI */
 
 #endif /* BMx280_H_ */
@@ -0,0 +1,157 @@
+/**
+ * @file BMx280_benchmark.c
+ * @ingroup BMx280
+ * @brief Проверка точности и скорости целочисленных вычислений BMP/BME280 на ПК
+ * @details Программа для ПК, в прошивку не входит: без макроса BMx280_BENCHMARK файл пустой. Сборка и запуск:
+ * 	\code
+ * 	gcc -O2 -DBMx280_BENCHMARK BMx280_benchmark.c BMx280_compensate.c -lm -o BMx280_benchmark
+ * 	./BMx280_benchmark
+ * 	\endcode
+ * 	Для проверки AVX2 версии @ref BMx280_compensate_batch добавьте -mavx2:
+ * 	\code
+ * 	gcc -O2 -mavx2 -DBMx280_BENCHMARK BMx280_benchmark.c BMx280_compensate.c -lm -o BMx280_benchmark
+ * 	\endcode
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifdef BMx280_BENCHMARK
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "BMx280_compensate.h"
+
+#define BMx280_BENCHMARK_SAMPLES		4000000		//!< Количество измерений для замера скорости
+
+//!< Калибровочные коэффициенты из примера в документации Bosch и типичные коэффициенты влажности BME280
+const BMx280_calibration_data BMx280_benchmark_calibration = {
+	27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+	75, 362, 0, 313, 50, 30
+};
+
+
+uint32_t __BMx280_benchmark_random(uint32_t *seed) {
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+
+double __BMx280_benchmark_seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+double __BMx280_altitude_reference(uint32_t refPressure, int32_t temp, uint32_t press) {
+	return 29.254 * (temp / 100. + 273.15) * log(refPressure / (press / 256.)) * 1000.;
+}
+
+
+void __BMx280_benchmark_altitude(void) {
+	//!< Ошибка относительно формулы в double во всем диапазоне датчика: 300..1100 гПа, -40..+85 °C, опорное давление 950..1050 гПа
+	double worst = 0;
+	for (uint32_t press = 300 * 100 * 256; press <= 1100 * 100 * 256; press += 977) {
+		for (int32_t temp = -4000; temp <= 8500; temp += 250) {
+			for (uint32_t refPressure = 95000; refPressure <= 105000; refPressure += 2500) {
+				double error = fabs(BMx280_altitude(refPressure, temp, press) - __BMx280_altitude_reference(refPressure, temp, press));
+				if (error > worst) {
+					worst = error;
+				}
+			}
+		}
+	}
+	printf("altitude: max error %.1f mm\n", worst);
+
+	static uint32_t press[BMx280_BENCHMARK_SAMPLES];
+	static int32_t temp[BMx280_BENCHMARK_SAMPLES];
+	uint32_t seed = 1;
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		press[i] = (30000 + __BMx280_benchmark_random(&seed) % 80000) * 256;
+		temp[i] = -4000 + (int32_t)(__BMx280_benchmark_random(&seed) % 12500);
+	}
+
+	//!< Сумма результатов выводится, чтобы компилятор не выбросил вычисления
+	int64_t sum_int = 0;
+	clock_t start = clock();
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		sum_int += BMx280_altitude(101325, temp[i], press[i]);
+	}
+	double time_int = __BMx280_benchmark_seconds(start);
+
+	double sum_double = 0;
+	start = clock();
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		sum_double += __BMx280_altitude_reference(101325, temp[i], press[i]);
+	}
+	double time_double = __BMx280_benchmark_seconds(start);
+
+	printf("altitude: integer %.1f ns, double %.1f ns per sample (checksum %lld %.0f)\n",
+			time_int * 1e9 / BMx280_BENCHMARK_SAMPLES, time_double * 1e9 / BMx280_BENCHMARK_SAMPLES, (long long)sum_int, sum_double);
+}
+
+
+void __BMx280_benchmark_batch(void) {
+	static int32_t adc_T[BMx280_BENCHMARK_SAMPLES], adc_P[BMx280_BENCHMARK_SAMPLES], adc_H[BMx280_BENCHMARK_SAMPLES];
+	static int32_t temp_ref[BMx280_BENCHMARK_SAMPLES], temp[BMx280_BENCHMARK_SAMPLES];
+	static uint32_t press_ref[BMx280_BENCHMARK_SAMPLES], press[BMx280_BENCHMARK_SAMPLES];
+	static uint32_t hum_ref[BMx280_BENCHMARK_SAMPLES], hum[BMx280_BENCHMARK_SAMPLES];
+	const BMx280_calibration_data *calibration = &BMx280_benchmark_calibration;
+
+	uint32_t seed = 2;
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		adc_T[i] = 400000 + (int32_t)(__BMx280_benchmark_random(&seed) % 250000);
+		adc_P[i] = 200000 + (int32_t)(__BMx280_benchmark_random(&seed) % 450000);
+		adc_H[i] = 20000 + (int32_t)(__BMx280_benchmark_random(&seed) % 30000);
+	}
+
+	//!< Выходные массивы заполняются заранее, чтобы первое обращение к страницам памяти не попало в замер
+	memset(temp, 0, sizeof(temp));
+	memset(press, 0, sizeof(press));
+	memset(hum, 0, sizeof(hum));
+	memset(temp_ref, 0, sizeof(temp_ref));
+	memset(press_ref, 0, sizeof(press_ref));
+	memset(hum_ref, 0, sizeof(hum_ref));
+
+	clock_t start = clock();
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		int32_t t_fine;
+		temp_ref[i] = BMx280_compensate_T(calibration, adc_T[i], &t_fine);
+		press_ref[i] = BMx280_compensate_P_int64(calibration, t_fine, adc_P[i]);
+		hum_ref[i] = BMx280_compensate_H(calibration, t_fine, adc_H[i]);
+	}
+	double time_ref = __BMx280_benchmark_seconds(start);
+
+	start = clock();
+	BMx280_compensate_batch(calibration, adc_T, adc_P, adc_H, temp, press, hum, BMx280_BENCHMARK_SAMPLES);
+	double time_batch = __BMx280_benchmark_seconds(start);
+
+	uint32_t mismatches = 0;
+	for (uint32_t i = 0; i < BMx280_BENCHMARK_SAMPLES; i++) {
+		if (temp[i] != temp_ref[i] || press[i] != press_ref[i] || hum[i] != hum_ref[i]) {
+			mismatches++;
+		}
+	}
+
+	//!< BMP280: без выходного массива влажности функция не должна к нему обращаться
+	BMx280_compensate_batch(calibration, adc_T, adc_P, adc_H, temp, press, NULL, BMx280_BENCHMARK_SAMPLES);
+
+#ifdef __AVX2__
+	const char *mode = "AVX2";
+#else
+	const char *mode = "scalar";
+#endif /* __AVX2__ */
+	printf("batch (%s): %u mismatches, reference %.1f, batch %.1f Msamples/s\n", mode, mismatches,
+			BMx280_BENCHMARK_SAMPLES / time_ref * 1e-6, BMx280_BENCHMARK_SAMPLES / time_batch * 1e-6);
+}
+
+
+int main(void) {
+	__BMx280_benchmark_altitude();
+	__BMx280_benchmark_batch();
+
+	return 0;
+}
+
+#endif /* BMx280_BENCHMARK */
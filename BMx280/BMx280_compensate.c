@@ -0,0 +1,270 @@
+#include "BMx280_compensate.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif /* __AVX2__ */
+
+//!< log2(1 + i / 256) в формате Q24 для вычисления высоты без плавающей точки
+const uint32_t BMx280_log2_table[257] = {
+	0x0000000, 0x001709C, 0x002DFCA, 0x0044D8C, 0x005B9E6, 0x00724D9, 0x0088E69, 0x009F698,
+	0x00B5D6A, 0x00CC2E0, 0x00E26FD, 0x00F89C5, 0x010EB39, 0x0124B5B, 0x013AA30, 0x01507B8,
+	0x01663F7, 0x017BEEF, 0x01918A1, 0x01A7112, 0x01BC842, 0x01D1E35, 0x01E72EC, 0x01FC66A,
+	0x02118B1, 0x02269C3, 0x023B9A3, 0x0250853, 0x02655D4, 0x027A229, 0x028ED54, 0x02A3757,
+	0x02B8034, 0x02CC7EE, 0x02E0E86, 0x02F53FE, 0x0309858, 0x031DB96, 0x0331DBA, 0x0345EC6,
+	0x0359EBC, 0x036DD9E, 0x0381B6E, 0x039582C, 0x03A93DD, 0x03BCE80, 0x03D0818, 0x03E40A6,
+	0x03F782D, 0x040AEAF, 0x041E42B, 0x04318A6, 0x0444C1F, 0x0457E9A, 0x046B017, 0x047E098,
+	0x049101F, 0x04A3EAD, 0x04B6C44, 0x04C98E6, 0x04DC493, 0x04EEF4F, 0x0501919, 0x05141F4,
+	0x05269E1, 0x05390E2, 0x054B6F8, 0x055DC24, 0x0570069, 0x05823C7, 0x0594640, 0x05A67D5,
+	0x05B8887, 0x05CA859, 0x05DC74B, 0x05EE55F, 0x0600296, 0x0611EF1, 0x0623A72, 0x063551A,
+	0x0646EEA, 0x06587E4, 0x066A009, 0x067B75A, 0x068CDD8, 0x069E385, 0x06AF862, 0x06C0C70,
+	0x06D1FB0, 0x06E3223, 0x06F43CC, 0x07054AA, 0x07164BF, 0x072740C, 0x0738292, 0x0749053,
+	0x0759D50, 0x076A989, 0x077B4FF, 0x078BFB5, 0x079C9AB, 0x07AD2E1, 0x07BDB5A, 0x07CE316,
+	0x07DEA16, 0x07EF05B, 0x07FF5E6, 0x080FAB9, 0x081FED4, 0x0830239, 0x08404E8, 0x08506E2,
+	0x0860828, 0x08708BC, 0x088089E, 0x08907CF, 0x08A0650, 0x08B0422, 0x08C0146, 0x08CFDBE,
+	0x08DF989, 0x08EF4A9, 0x08FEF1F, 0x090E8EB, 0x091E20F, 0x092DA8B, 0x093D260, 0x094C990,
+	0x095C01A, 0x096B601, 0x097AB44, 0x0989FE4, 0x09993E3, 0x09A8742, 0x09B7A00, 0x09C6C1F,
+	0x09D5DA0, 0x09E4E83, 0x09F3ECA, 0x0A02E74, 0x0A11D84, 0x0A20BF9, 0x0A2F9D5, 0x0A3E718,
+	0x0A4D3C2, 0x0A5BFD6, 0x0A6AB53, 0x0A7963A, 0x0A8808C, 0x0A96A4A, 0x0AA5374, 0x0AB3C0C,
+	0x0AC2411, 0x0AD0B85, 0x0ADF268, 0x0AED8BC, 0x0AFBE80, 0x0B0A3B5, 0x0B1885C, 0x0B26C77,
+	0x0B35004, 0x0B43306, 0x0B5157D, 0x0B5F769, 0x0B6D8CB, 0x0B7B9A4, 0x0B899F5, 0x0B979BD,
+	0x0BA58FF, 0x0BB37B9, 0x0BC15EE, 0x0BCF39D, 0x0BDD0C8, 0x0BEAD6E, 0x0BF8991, 0x0C06531,
+	0x0C1404F, 0x0C21AEB, 0x0C2F506, 0x0C3CEA0, 0x0C4A7BA, 0x0C58055, 0x0C65872, 0x0C73010,
+	0x0C80731, 0x0C8DDD4, 0x0C9B3FB, 0x0CA89A7, 0x0CB5ED7, 0x0CC338C, 0x0CD07C7, 0x0CDDB88,
+	0x0CEAED0, 0x0CF819F, 0x0D053F7, 0x0D125D7, 0x0D1F740, 0x0D2C832, 0x0D398AF, 0x0D468B6,
+	0x0D53848, 0x0D60765, 0x0D6D60F, 0x0D7A446, 0x0D87209, 0x0D93F5A, 0x0DA0C3A, 0x0DAD8A8,
+	0x0DBA4A4, 0x0DC7031, 0x0DD3B4E, 0x0DE05FB, 0x0DED039, 0x0DF9A09, 0x0E0636A, 0x0E12C5E,
+	0x0E1F4E5, 0x0E2BCFF, 0x0E384AD, 0x0E44BF0, 0x0E512C7, 0x0E5D933, 0x0E69F35, 0x0E764CD,
+	0x0E829FB, 0x0E8EEC1, 0x0E9B31E, 0x0EA7712, 0x0EB3A9F, 0x0EBFDC5, 0x0ECC083, 0x0ED82DB,
+	0x0EE44CD, 0x0EF065A, 0x0EFC781, 0x0F08843, 0x0F148A1, 0x0F2089B, 0x0F2C832, 0x0F38765,
+	0x0F44636, 0x0F504A4, 0x0F5C2B0, 0x0F6805A, 0x0F73DA4, 0x0F7FA8C, 0x0F8B714, 0x0F9733C,
+	0x0FA2F04, 0x0FAEA6D, 0x0FBA578, 0x0FC6023, 0x0FD1A71, 0x0FDD460, 0x0FE8DF2, 0x0FF4728,
+	0x1000000
+};
+
+
+int32_t BMx280_compensate_T(const BMx280_calibration_data *calibration_data, int32_t adc_T, int32_t *t_fine) {
+	int32_t var1, var2, T;
+
+	var1 = ((((adc_T >> 3) - ((int32_t)calibration_data->dig_T1 << 1))) * ((int32_t)calibration_data->dig_T2)) >> 11;
+	var2 = (((((adc_T >> 4) - ((int32_t)calibration_data->dig_T1)) * ((adc_T >> 4) - ((int32_t)calibration_data->dig_T1))) >> 12) *
+		((int32_t)calibration_data->dig_T3)) >> 14;
+	
+	*t_fine = var1 + var2;
+	
+	T = (*t_fine * 5 + 128) >> 8;
+	
+	return T;
+}
+
+uint32_t BMx280_compensate_P_int64(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_P) {
+	int64_t var1, var2, p;
+
+	var1 = ((int64_t)t_fine) - 128000;
+
+	var2 = var1 * var1 * (int64_t)calibration_data->dig_P6;
+	var2 = var2 + ((var1 * (int64_t)calibration_data->dig_P5) << 17);
+	var2 = var2 + (((int64_t)calibration_data->dig_P4) << 35);
+
+	var1 = ((var1 * var1 * (int64_t)calibration_data->dig_P3) >> 8) + ((var1 * (int64_t)calibration_data->dig_P2) << 12);
+	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)calibration_data->dig_P1) >> 33;
+
+	if (var1 == 0)
+	{
+		return 0; // avoid exception caused by division by zero
+	}
+
+	p = 1048576 - adc_P;
+	p = (((p << 31) - var2) * 3125) / var1;
+
+	var1 = (((int64_t)calibration_data->dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+	var2 = (((int64_t)calibration_data->dig_P8) * p) >> 19;
+
+	p = ((p + var1 + var2) >> 8) + (((int64_t)calibration_data->dig_P7) << 4);
+
+	return (uint32_t)p;
+}
+
+uint32_t BMx280_compensate_P_int32(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_P) {
+	int32_t var1, var2;
+	uint32_t p;
+
+	var1 = (((int32_t)t_fine) >> 1) - (int32_t)64000;
+	var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)calibration_data->dig_P6);
+	var2 = var2 + ((var1 * ((int32_t)calibration_data->dig_P5)) << 1);
+	var2 = (var2 >> 2) + (((int32_t)calibration_data->dig_P4) << 16);
+	var1 = (((calibration_data->dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)calibration_data->dig_P2) * var1) >> 1)) >> 18;
+	var1 = ((((32768 + var1)) * ((int32_t)calibration_data->dig_P1)) >> 15);
+
+	if (var1 == 0)
+	{
+		return 0; // avoid exception caused by division by zero
+	}
+
+	p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+	if (p < 0x80000000)
+	{
+		p = (p << 1) / ((uint32_t)var1);
+	}
+	else
+	{
+		p = (p / (uint32_t)var1) * 2;
+	}
+
+	var1 = (((int32_t)calibration_data->dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+	var2 = (((int32_t)(p >> 2)) * ((int32_t)calibration_data->dig_P8)) >> 13;
+	p = (uint32_t)((int32_t)p + ((var1 + var2 + calibration_data->dig_P7) >> 4));
+
+	return p;
+}
+
+uint32_t BMx280_compensate_H(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_H)
+{
+	int32_t v_x1_u32r;
+
+	v_x1_u32r = (t_fine - ((int32_t)76800));
+	v_x1_u32r = (((((adc_H << 14) - (((int32_t)calibration_data->dig_H4) << 20) - (((int32_t)calibration_data->dig_H5) *
+		v_x1_u32r)) + ((int32_t)16384)) >> 15) * (((((((v_x1_u32r *
+		((int32_t)calibration_data->dig_H6)) >> 10) * (((v_x1_u32r * ((int32_t)calibration_data->dig_H3)) >> 11) +
+		((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)calibration_data->dig_H2) + 8192) >> 14));
+
+	v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)calibration_data->dig_H1)) >> 4));
+	v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
+	v_x1_u32r = (v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r);
+
+	return (uint32_t)(v_x1_u32r >> 12);
+}
+
+int32_t __BMx280_log2_q24(uint32_t x) {
+	//!< Целая часть логарифма - номер старшего единичного бита, дробная - из таблицы с линейной интерполяцией
+	uint32_t e = 31 - (uint32_t)__builtin_clz(x);
+	uint32_t m = x << (31 - e);
+	uint32_t idx = (m >> 23) & 0xFF;
+	uint32_t rem = (m >> 9) & 0x3FFF;
+
+	return (int32_t)((e << 24) + BMx280_log2_table[idx] + (((BMx280_log2_table[idx + 1] - BMx280_log2_table[idx]) * rem) >> 14));
+}
+
+int32_t BMx280_altitude(uint32_t refPressure, int32_t temp, uint32_t press) {
+	if (press == 0) {
+		return 0;
+	}
+
+	//!< ln(p_ref / p) = ln2 * (log2(p_ref) - log2(p)). Давление в Q24.8, поэтому опорное давление сдвигаем на 8 бит
+	int64_t h = (int64_t)(__BMx280_log2_q24(refPressure << 8) - __BMx280_log2_q24(press)) * (temp + 27315);
+
+	//!< h = 29.254 * ln2 * 1000 / 100 * (T + 27315) * dlog2 / 2^24. Коэффициент хранится в Q16
+	return (int32_t)((((h >> 12) * BMx280_ALTITUDE_K) + (1 << 27)) >> 28);
+}
+
+#ifdef __AVX2__
+//!< В AVX2 нет арифметического сдвига и умножения 64-битных элементов, собираем их из 32-битных операций
+#define __BMx280_srai_epi64(X, N)		_mm256_or_si256(_mm256_srli_epi64((X), (N)), _mm256_slli_epi64(_mm256_cmpgt_epi64(_mm256_setzero_si256(), (X)), 64 - (N)))
+
+__m256i __BMx280_mullo_epi64(__m256i a, __m256i b) {
+	__m256i lo = _mm256_mul_epu32(a, b);
+	__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+
+	return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+void __BMx280_compensate_P_avx2(const BMx280_calibration_data *calibration_data, const int32_t *t_fine, const int32_t *adc_P, uint32_t *press) {
+	//!< Множители до деления вычисляются по 4 измерения, t_fine - 128000 помещается в 32 бита, поэтому var1 * var1 точно считается _mm256_mul_epi32
+	__m256i var1 = _mm256_sub_epi64(_mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)t_fine)), _mm256_set1_epi64x(128000));
+	__m256i var1_sq = _mm256_mul_epi32(var1, var1);
+
+	__m256i var2 = __BMx280_mullo_epi64(var1_sq, _mm256_set1_epi64x(calibration_data->dig_P6));
+	var2 = _mm256_add_epi64(var2, _mm256_slli_epi64(_mm256_mul_epi32(var1, _mm256_set1_epi64x(calibration_data->dig_P5)), 17));
+	var2 = _mm256_add_epi64(var2, _mm256_set1_epi64x(((int64_t)calibration_data->dig_P4) << 35));
+
+	__m256i var1_p = _mm256_add_epi64(__BMx280_srai_epi64(__BMx280_mullo_epi64(var1_sq, _mm256_set1_epi64x(calibration_data->dig_P3)), 8),
+			_mm256_slli_epi64(_mm256_mul_epi32(var1, _mm256_set1_epi64x(calibration_data->dig_P2)), 12));
+	var1_p = _mm256_add_epi64(var1_p, _mm256_set1_epi64x(((int64_t)1) << 47));
+	var1_p = __BMx280_srai_epi64(__BMx280_mullo_epi64(var1_p, _mm256_set1_epi64x(calibration_data->dig_P1)), 33);
+
+	int64_t var1_lanes[4], var2_lanes[4];
+	_mm256_storeu_si256((__m256i *)var1_lanes, var1_p);
+	_mm256_storeu_si256((__m256i *)var2_lanes, var2);
+
+	//!< 64-битное деление в AVX2 отсутствует, оставшаяся часть формулы считается поэлементно
+	for (int i = 0; i < 4; i++) {
+		if (var1_lanes[i] == 0) {
+			press[i] = 0;
+			continue;
+		}
+
+		int64_t p = 1048576 - adc_P[i];
+		p = (((p << 31) - var2_lanes[i]) * 3125) / var1_lanes[i];
+
+		int64_t v1 = (((int64_t)calibration_data->dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+		int64_t v2 = (((int64_t)calibration_data->dig_P8) * p) >> 19;
+
+		press[i] = (uint32_t)(((p + v1 + v2) >> 8) + (((int64_t)calibration_data->dig_P7) << 4));
+	}
+}
+
+void __BMx280_compensate_TH_avx2(const BMx280_calibration_data *calibration_data, const int32_t *adc_T, const int32_t *adc_H,
+		int32_t *t_fine, int32_t *temp, uint32_t *hum) {
+	__m256i T = _mm256_loadu_si256((const __m256i *)adc_T);
+	__m256i T1 = _mm256_set1_epi32(calibration_data->dig_T1);
+
+	__m256i var1 = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(_mm256_srai_epi32(T, 3), _mm256_slli_epi32(T1, 1)),
+			_mm256_set1_epi32(calibration_data->dig_T2)), 11);
+	__m256i diff = _mm256_sub_epi32(_mm256_srai_epi32(T, 4), T1);
+	__m256i var2 = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_srai_epi32(_mm256_mullo_epi32(diff, diff), 12),
+			_mm256_set1_epi32(calibration_data->dig_T3)), 14);
+	__m256i fine = _mm256_add_epi32(var1, var2);
+
+	_mm256_storeu_si256((__m256i *)t_fine, fine);
+	_mm256_storeu_si256((__m256i *)temp, _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(fine, _mm256_set1_epi32(5)), _mm256_set1_epi32(128)), 8));
+
+	if (adc_H == NULL) {
+		return;
+	}
+
+	__m256i v = _mm256_sub_epi32(fine, _mm256_set1_epi32(76800));
+	__m256i x = _mm256_sub_epi32(_mm256_slli_epi32(_mm256_loadu_si256((const __m256i *)adc_H), 14), _mm256_set1_epi32(((int32_t)calibration_data->dig_H4) << 20));
+	x = _mm256_sub_epi32(x, _mm256_mullo_epi32(_mm256_set1_epi32(calibration_data->dig_H5), v));
+	x = _mm256_srai_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(16384)), 15);
+
+	__m256i y = _mm256_srai_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(calibration_data->dig_H6)), 10);
+	__m256i z = _mm256_add_epi32(_mm256_srai_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(calibration_data->dig_H3)), 11), _mm256_set1_epi32(32768));
+	y = _mm256_add_epi32(_mm256_srai_epi32(_mm256_mullo_epi32(y, z), 10), _mm256_set1_epi32(2097152));
+	y = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(calibration_data->dig_H2)), _mm256_set1_epi32(8192)), 14);
+	v = _mm256_mullo_epi32(x, y);
+
+	__m256i s = _mm256_srai_epi32(v, 15);
+	s = _mm256_srai_epi32(_mm256_mullo_epi32(_mm256_srai_epi32(_mm256_mullo_epi32(s, s), 7), _mm256_set1_epi32(calibration_data->dig_H1)), 4);
+	v = _mm256_sub_epi32(v, s);
+	v = _mm256_max_epi32(v, _mm256_setzero_si256());
+	v = _mm256_min_epi32(v, _mm256_set1_epi32(419430400));
+
+	_mm256_storeu_si256((__m256i *)hum, _mm256_srai_epi32(v, 12));
+}
+#endif /* __AVX2__ */
+
+void BMx280_compensate_batch(const BMx280_calibration_data *calibration_data, const int32_t *adc_T, const int32_t *adc_P, const int32_t *adc_H,
+		int32_t *temp, uint32_t *press, uint32_t *hum, uint32_t count) {
+	uint32_t i = 0;
+
+	//!< Влажность вычисляется, только если заданы и входной, и выходной массивы
+	uint8_t humidity = adc_H != NULL && hum != NULL;
+
+#ifdef __AVX2__
+	int32_t t_fine[8];
+	for (; i + 8 <= count; i += 8) {
+		__BMx280_compensate_TH_avx2(calibration_data, &adc_T[i], humidity ? &adc_H[i] : NULL, t_fine, &temp[i], humidity ? &hum[i] : NULL);
+		__BMx280_compensate_P_avx2(calibration_data, &t_fine[0], &adc_P[i], &press[i]);
+		__BMx280_compensate_P_avx2(calibration_data, &t_fine[4], &adc_P[i + 4], &press[i + 4]);
+	}
+#endif /* __AVX2__ */
+
+	//!< Остаток массива (или весь массив без AVX2) обрабатывается эталонными функциями
+	for (; i < count; i++) {
+		int32_t fine;
+		temp[i] = BMx280_compensate_T(calibration_data, adc_T[i], &fine);
+		press[i] = BMx280_compensate_P_int64(calibration_data, fine, adc_P[i]);
+		if (humidity) {
+			hum[i] = BMx280_compensate_H(calibration_data, fine, adc_H[i]);
+		}
+	}
+}
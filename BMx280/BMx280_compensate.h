@@ -0,0 +1,128 @@
+/**
+ * @file BMx280_compensate.h
+ * @ingroup BMx280
+ * @brief Целочисленная компенсация данных АЦП BMP/BME280 по калибровочным коэффициентам
+ * @details Функции не зависят от HAL и используются как драйвером на МК, так и на ПК для обработки
+ * 	записанных во время полета данных АЦП.
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef BMx280_COMPENSATE_H_
+#define BMx280_COMPENSATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** @cond UNNECESSARY */
+/* Calibration data for temperature and pressure */
+typedef struct {
+	uint16_t dig_T1;
+	int16_t dig_T2;
+	int16_t dig_T3;
+	uint16_t dig_P1;
+	int16_t dig_P2;
+	int16_t dig_P3;
+	int16_t dig_P4;
+	int16_t dig_P5;
+	int16_t dig_P6;
+	int16_t dig_P7;
+	int16_t dig_P8;
+	int16_t dig_P9;
+	uint8_t dig_H1;
+	int16_t dig_H2;
+	uint8_t dig_H3;
+	int16_t dig_H4;
+	int16_t dig_H5;
+	int8_t dig_H6;
+} BMx280_calibration_data;
+
+#define BMx280_ALTITUDE_K				13288949	// 29.254 * ln2 * 1000 / 100 в формате Q16
+/** @endcond */
+
+/**
+ * @brief Компенсация температуры
+ * @ingroup BMx280
+ *
+ * @param[in] calibration_data Калибровочные коэффициенты датчика
+ * @param[in] adc_T Данные АЦП температуры
+ * @param[out] t_fine Промежуточное значение температуры для компенсации давления и влажности
+ * @return int32_t Температура в сотых долях градуса Цельсия
+ */
+int32_t BMx280_compensate_T(const BMx280_calibration_data *calibration_data, int32_t adc_T, int32_t *t_fine);
+
+/**
+ * @brief Компенсация давления в 64-битной арифметике
+ * @ingroup BMx280
+ *
+ * @param[in] calibration_data Калибровочные коэффициенты датчика
+ * @param[in] t_fine Результат @ref BMx280_compensate_T для того же измерения
+ * @param[in] adc_P Данные АЦП давления
+ * @return uint32_t Давление в Па в формате Q24.8
+ */
+uint32_t BMx280_compensate_P_int64(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_P);
+
+/**
+ * @brief Компенсация давления в 32-битной арифметике
+ * @ingroup BMx280
+ *
+ * @param[in] calibration_data Калибровочные коэффициенты датчика
+ * @param[in] t_fine Результат @ref BMx280_compensate_T для того же измерения
+ * @param[in] adc_P Данные АЦП давления
+ * @return uint32_t Давление в Па
+ */
+uint32_t BMx280_compensate_P_int32(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_P);
+
+/**
+ * @brief Компенсация влажности
+ * @ingroup BMx280
+ *
+ * @param[in] calibration_data Калибровочные коэффициенты датчика
+ * @param[in] t_fine Результат @ref BMx280_compensate_T для того же измерения
+ * @param[in] adc_H Данные АЦП влажности
+ * @return uint32_t Влажность в % в формате Q22.10
+ */
+uint32_t BMx280_compensate_H(const BMx280_calibration_data *calibration_data, int32_t t_fine, int32_t adc_H);
+
+/**
+ * @brief Вычисление высоты в целых числах
+ * @ingroup BMx280
+ * @details Вычисляет ту же величину, что и формула @f$ 29.254 \cdot (T + 273.15) \cdot \log(\frac{pres_{ref}}{pres})@f$,
+ * 	но без плавающей точки: логарифм отношения давлений вычисляется как разность двоичных логарифмов, целая часть которых
+ * 	определяется инструкцией CLZ, а дробная - по таблице на 256 отрезков с линейной интерполяцией.
+ * 	Используется вместо функций измерения, если высота нужна быстро на МК без FPU (F103), где log() в double
+ * 	занимает тысячи тактов.
+ *
+ * @note Погрешность относительно формулы в double не превышает 2 см во всем диапазоне работы датчика
+ * 	(300..1100 гПа, -40..+85 °C). Погрешность и время вычисления проверяются программой BMx280_benchmark.c.
+ *
+ * @param[in] refPressure Давление, относительно которого вычисляется высота, в Па
+ * @param[in] temp Температура в сотых долях градуса Цельсия
+ * @param[in] press Давление в Па в формате Q24.8 (результат целочисленной компенсации)
+ * @return int32_t Высота в мм
+ */
+int32_t BMx280_altitude(uint32_t refPressure, int32_t temp, uint32_t press);
+
+/**
+ * @brief Компенсация массива записанных данных АЦП
+ * @ingroup BMx280
+ * @details Предназначена для обработки записанных данных на ПК. При сборке с поддержкой AVX2 (-mavx2) температура и влажность
+ * 	обрабатываются по 8 измерений, давление до деления - по 4 измерения в 64-битных элементах, деление и последние шаги - поэлементно.
+ * 	Без AVX2 используется цикл по функциям @ref BMx280_compensate_T, @ref BMx280_compensate_P_int64, @ref BMx280_compensate_H.
+ * 	Результат в обоих случаях побитово совпадает с результатом этих функций. Влажность вычисляется, только если
+ * 	заданы оба массива adc_H и hum. Скорость проверяется программой BMx280_benchmark.c.
+ *
+ * @param[in] calibration_data Калибровочные коэффициенты датчика
+ * @param[in] adc_T Массив данных АЦП температуры
+ * @param[in] adc_P Массив данных АЦП давления
+ * @param[in] adc_H Массив данных АЦП влажности. NULL для BMP280
+ * @param[out] temp Температура в сотых долях градуса Цельсия
+ * @param[out] press Давление в Па в формате Q24.8
+ * @param[out] hum Влажность в % в формате Q22.10. NULL для BMP280
+ * @param[in] count Количество измерений
+ */
+void BMx280_compensate_batch(const BMx280_calibration_data *calibration_data, const int32_t *adc_T, const int32_t *adc_P, const int32_t *adc_H,
+		int32_t *temp, uint32_t *press, uint32_t *hum, uint32_t count);
+
+#endif /* BMx280_COMPENSATE_H_ */
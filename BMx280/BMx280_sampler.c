@@ -0,0 +1,102 @@
+#include "BMx280_sampler.h"
+#include "string.h"
+
+//!< Значение АЦП после сброса, пока не закончилось первое измерение
+#define BMx280_SAMPLER_ADC_RESET		0x80000
+
+
+HAL_StatusTypeDef BMx280_sampler_start(BMx280_sampler_t *sampler, BMx280_t *dev) {
+	memset(sampler, 0, sizeof(BMx280_sampler_t));
+
+	sampler->dev = dev;
+	sampler->period = BMx280_get_period(dev);
+	sampler->next = HAL_GetTick();
+
+	return BMx280_normal_measure(dev);
+}
+
+
+HAL_StatusTypeDef BMx280_sampler_poll(BMx280_sampler_t *sampler) {
+	HAL_StatusTypeDef status;
+
+	uint32_t now = HAL_GetTick();
+	if ((int32_t)(now - sampler->next) < 0) {
+		return HAL_BUSY;
+	}
+
+	uint8_t BMx_status;
+	BMx280_raw_t raw;
+	if ((status = BMx280_get_raw_status(sampler->dev, &BMx_status, &raw)) != HAL_OK) {
+		return status;
+	}
+
+	//!< С сильным фильтром IIR неподвижный датчик выдает те же данные, что и в прошлый раз. Если с прошлого чтения
+	//!< прошло больше периода и датчик не измеряет, очередное измерение закончено, и данные принимаются как новые
+	uint8_t unchanged = sampler->started && raw.adc_P == sampler->raw.adc_P && raw.adc_T == sampler->raw.adc_T && raw.adc_H == sampler->raw.adc_H &&
+		((BMx_status & BMx280_STATUS_MEASURING) || now - sampler->last < (sampler->period + 1999) / 1000);
+
+	//!< Датчик еще не закончил первое измерение или новое измерение еще не записано в регистры.
+	//!< Повторное чтение откладывается на 1 мс, а не выполняется при каждом вызове
+	if (raw.adc_T == BMx280_SAMPLER_ADC_RESET || unchanged) {
+		sampler->next = now + 1;
+		return HAL_BUSY;
+	}
+
+	//!< Если с прошлого чтения прошло больше полутора периодов, часть измерений перезаписана датчиком.
+	//!< Время считается в 64 битах: в мкс 32-битный счетчик переполнился бы через 71 минуту без опроса
+	if (sampler->started) {
+		uint64_t elapsed = (uint64_t)(now - sampler->last) * 1000;
+		uint32_t periods = (uint32_t)((elapsed + sampler->period / 2) / sampler->period);
+		if (periods > 1) {
+			sampler->missed += periods - 1;
+		}
+	}
+
+	sampler->raw = raw;
+	sampler->last = now;
+	sampler->started = 1;
+
+	//!< Следующее измерение ожидается через период. Опрос начинаем на 1 мс раньше из-за дискретности HAL_GetTick
+	uint32_t period_ms = sampler->period / 1000;
+	sampler->next = now + (period_ms > 1 ? period_ms - 1 : 0);
+
+	//!< Запись выполняет только писатель: при заполненном буфере новое измерение отбрасывается
+	uint16_t head = sampler->head;
+	if ((uint16_t)(head - sampler->tail) >= BMx280_SAMPLER_SIZE) {
+		sampler->overruns++;
+		return HAL_OK;
+	}
+
+	BMx280_sample_t *sample = &sampler->buffer[head & (BMx280_SAMPLER_SIZE - 1)];
+	sample->tick = now;
+	sample->raw = raw;
+	sample->hum = 0;
+	BMx280_compensate_raw(sampler->dev, &raw, &sample->temp, &sample->press, sampler->dev->id == 0x60 ? &sample->hum : NULL, &sample->h);
+
+	//!< Запись должна быть заполнена до того, как читатель увидит новый индекс
+	__DMB();
+	sampler->head = head + 1;
+
+	return HAL_OK;
+}
+
+
+uint8_t BMx280_sampler_pop(BMx280_sampler_t *sampler, BMx280_sample_t *sample) {
+	uint16_t tail = sampler->tail;
+	if (tail == sampler->head) {
+		return 0;
+	}
+
+	*sample = sampler->buffer[tail & (BMx280_SAMPLER_SIZE - 1)];
+
+	//!< Запись скопирована до того, как писатель сможет ее перезаписать
+	__DMB();
+	sampler->tail = tail + 1;
+
+	return 1;
+}
+
+
+uint16_t BMx280_sampler_count(BMx280_sampler_t *sampler) {
+	return (uint16_t)(sampler->head - sampler->tail);
+}
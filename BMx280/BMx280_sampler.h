@@ -0,0 +1,119 @@
+/**
+ * @defgroup BMx280_sampler BMx280 sampler
+ * @ingroup BMx280
+ * @brief Равномерная выборка измерений BMP/BME280 в режиме normal с метками времени.
+ * @details В режиме normal датчик сам повторяет измерения с периодом @ref BMx280_get_period, а чтение регистров
+ * 	в произвольный момент возвращает последнее готовое измерение. Сэмплер опрашивает датчик только после
+ * 	ожидаемого окончания очередного измерения, отбрасывает повторно прочитанные данные и кладет каждое новое
+ * 	измерение вместе с временем чтения в кольцевой буфер @ref BMx280_sampler_t.
+ *
+ * 	Буфер рассчитан на одного писателя и одного читателя без блокировок. @ref BMx280_sampler_poll читает датчик
+ * 	блокирующим обменом, таймаут которого отсчитывается по HAL_GetTick, поэтому его вызывают из основного цикла,
+ * 	в котором идут и остальные обмены по этой шине, а не из прерывания.
+ * 	\code{.c}
+ * 	BMx280_config(&baro, BMx280_OVERSAMPLING_2, BMx280_OVERSAMPLING_8, BMx280_OVERSAMPLING_1, BMx280_STANDBY_62_5, BMx280_FILTER_X4);
+ * 	BMx280_sampler_start(&sampler, &baro);
+ *
+ * 	while (1) {
+ * 		BMx280_sampler_poll(&sampler);
+ * 		while (BMx280_sampler_pop(&sampler, &sample)) {
+ * 			altitude_update(sample.tick, sample.h);
+ * 		}
+ * 	}
+ * 	\endcode
+ */
+/**
+ * @file BMx280_sampler.h
+ * @ingroup BMx280_sampler
+ * @brief API выборки измерений BMP/BME280 в режиме normal
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef BMx280_SAMPLER_H_
+#define BMx280_SAMPLER_H_
+
+#include "BMx280.h"
+
+#define BMx280_SAMPLER_SIZE				16			//!< Количество записей в кольцевом буфере. Должно быть степенью двойки
+
+/**
+ * @brief Одно измерение датчика
+ */
+typedef struct {
+	uint32_t tick;								//!< Время чтения измерения в мс (HAL_GetTick)
+	BMx280_raw_t raw;							//!< Данные АЦП
+	int32_t temp;								//!< Температура в сотых долях градуса Цельсия
+	uint32_t press;								//!< Давление в Па в формате Q24.8
+	uint32_t hum;								//!< Влажность в % в формате Q22.10. 0 для BMP280
+	int32_t h;									//!< Высота в мм
+} BMx280_sample_t;
+
+/**
+ * @brief Состояние сэмплера
+ */
+typedef struct {
+	BMx280_t *dev;								//!< Экземпляр датчика
+	uint32_t period;							//!< Период измерений в мкс
+	uint32_t next;								//!< Время, раньше которого новое измерение не ожидается, в мс
+	uint32_t last;								//!< Время чтения последнего измерения в мс
+	uint32_t missed;							//!< Количество пропущенных измерений датчика (опрос был слишком редким)
+	uint32_t overruns;							//!< Количество измерений, не поместившихся в буфер (буфер не читался)
+
+	/** @cond UNNECESSARY */
+	BMx280_raw_t raw;
+	uint8_t started;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	BMx280_sample_t buffer[BMx280_SAMPLER_SIZE];
+	/** @endcond */
+} BMx280_sampler_t;
+
+/**
+ * @brief Запуск выборки
+ * @ingroup BMx280_sampler
+ * @details Вычисляет период по текущей конфигурации датчика и переводит датчик в режим normal.
+ * 	После изменения конфигурации выборку нужно запустить заново.
+ *
+ * @param[out] sampler Состояние сэмплера
+ * @param[in] dev Инициализированный экземпляр датчика
+ * @return HAL_StatusTypeDef Результат отправки данных по I2C
+ */
+HAL_StatusTypeDef BMx280_sampler_start(BMx280_sampler_t *sampler, BMx280_t *dev);
+
+/**
+ * @brief Опрос датчика
+ * @ingroup BMx280_sampler
+ * @details До ожидаемого окончания измерения возвращает HAL_BUSY без обращения к шине. После него читает
+ * 	статус и данные одной транзакцией. Если данные не изменились, измерение еще не закончено, и функция
+ * 	возвращает HAL_BUSY. Новое измерение компенсируется и кладется в буфер.
+ * 	Не вызывайте функцию из прерывания: при приоритете не ниже SysTick таймаут обмена не истечет никогда,
+ * 	а обмен может прервать другой обмен по той же шине.
+ *
+ * @param[in,out] sampler Состояние сэмплера
+ * @return HAL_StatusTypeDef HAL_OK, если получено новое измерение, HAL_BUSY, если его еще нет,
+ * 	иначе результат получения данных по I2C
+ */
+HAL_StatusTypeDef BMx280_sampler_poll(BMx280_sampler_t *sampler);
+
+/**
+ * @brief Извлечение самого старого измерения из буфера
+ * @ingroup BMx280_sampler
+ *
+ * @param[in,out] sampler Состояние сэмплера
+ * @param[out] sample Измерение
+ * @return uint8_t 1, если измерение извлечено, 0, если буфер пуст
+ */
+uint8_t BMx280_sampler_pop(BMx280_sampler_t *sampler, BMx280_sample_t *sample);
+
+/**
+ * @brief Количество измерений в буфере
+ * @ingroup BMx280_sampler
+ *
+ * @param[in] sampler Состояние сэмплера
+ * @return uint16_t Количество непрочитанных измерений
+ */
+uint16_t BMx280_sampler_count(BMx280_sampler_t *sampler);
+
+#endif /* BMx280_SAMPLER_H_ */
@@ -0,0 +1,248 @@
+#include <math.h>
+#include <string.h>
+#include "Decimator.h"
+
+
+int16_t __Decimator_saturate(int32_t value) {
+	if (value > 32767) return 32767;
+	if (value < -32768) return -32768;
+	return (int16_t)value;
+}
+
+
+uint8_t Decimator_cic_init(Decimator_cic_t *cic, uint8_t order, uint8_t ratio, uint8_t channels) {
+	memset(cic, 0, sizeof(Decimator_cic_t));
+
+	if (order == 0 || order > DECIMATOR_CIC_MAX_ORDER || ratio == 0) return 0;
+	if (channels == 0 || channels > DECIMATOR_MAX_CHANNELS) return 0;
+
+	uint32_t gain = 1;
+	for (uint8_t k = 0; k < order; k++) {
+		gain *= ratio;
+	}
+	if (gain > 65536) return 0;
+
+	//!< Компенсация усиления ratio^order в формате Q31: выход CIC не превышает 2^31, произведение считается в 64 битах
+	cic->gain = (uint32_t)((1ULL << 31) / gain);
+	cic->order = order;
+	cic->ratio = ratio;
+	cic->channels = channels;
+	return 1;
+}
+
+
+uint16_t Decimator_cic_process(Decimator_cic_t *cic, const int16_t *in, uint16_t frames, int16_t *out) {
+	uint16_t produced = 0;
+	uint8_t order = cic->order;
+
+	for (uint16_t n = 0; n < frames; n++) {
+		//!< Интеграторы и гребенки считаются в беззнаковой арифметике: переполнение допустимо и взаимно компенсируется
+		for (uint8_t ch = 0; ch < cic->channels; ch++) {
+			uint32_t v = (uint32_t)(int32_t)in[n * cic->channels + ch];
+			uint32_t *integrator = cic->integrator[ch];
+			for (uint8_t k = 0; k < order; k++) {
+				integrator[k] += v;
+				v = integrator[k];
+			}
+		}
+
+		if (++cic->count < cic->ratio) continue;
+		cic->count = 0;
+
+		for (uint8_t ch = 0; ch < cic->channels; ch++) {
+			uint32_t v = cic->integrator[ch][order - 1];
+			uint32_t *comb = cic->comb[ch];
+			for (uint8_t k = 0; k < order; k++) {
+				uint32_t prev = comb[k];
+				comb[k] = v;
+				v -= prev;
+			}
+
+			int64_t y = ((int64_t)(int32_t)v * (int64_t)cic->gain + (1LL << 30)) >> 31;
+			out[produced * cic->channels + ch] = __Decimator_saturate((int32_t)y);
+		}
+		produced++;
+	}
+
+	return produced;
+}
+
+
+float __Decimator_design_tap(uint16_t i, uint16_t taps, float cutoff) {
+	//!< Идеальный ФНЧ sin(2*pi*fc*t)/(pi*t) с окном Хэмминга
+	float t = (float)i - (float)(taps - 1) * 0.5f;
+	float ideal = (t == 0.0f) ? 2.0f * cutoff : sinf(2.0f * DECIMATOR_PI * cutoff * t) / (DECIMATOR_PI * t);
+	float window = taps > 1 ? 0.54f - 0.46f * cosf(2.0f * DECIMATOR_PI * (float)i / (float)(taps - 1)) : 1.0f;
+	return ideal * window;
+}
+
+
+void Decimator_design_f32(float *h, uint16_t taps, float cutoff, uint8_t L) {
+	float sum = 0.0f;
+	for (uint16_t i = 0; i < taps; i++) {
+		h[i] = __Decimator_design_tap(i, taps, cutoff);
+		sum += h[i];
+	}
+
+	float scale = (float)L / sum;
+	for (uint16_t i = 0; i < taps; i++) {
+		h[i] *= scale;
+	}
+}
+
+
+void Decimator_design_q15(int16_t *h, uint16_t taps, float cutoff, uint8_t L) {
+	//!< Без промежуточного массива: сначала сумма коэффициентов, затем нормировка каждого коэффициента
+	float sum = 0.0f;
+	for (uint16_t i = 0; i < taps; i++) {
+		sum += __Decimator_design_tap(i, taps, cutoff);
+	}
+
+	float scale = 32768.0f * (float)L / sum;
+	for (uint16_t i = 0; i < taps; i++) {
+		float v = __Decimator_design_tap(i, taps, cutoff) * scale;
+		h[i] = __Decimator_saturate((int32_t)(v < 0 ? v - 0.5f : v + 0.5f));
+	}
+}
+
+
+uint8_t Decimator_fir_q15_init(Decimator_fir_q15_t *fir, const int16_t *coeffs, uint16_t taps, uint8_t L, uint8_t M, uint8_t channels) {
+	memset(fir, 0, sizeof(Decimator_fir_q15_t));
+
+	if (L == 0 || M == 0 || taps == 0 || taps % L) return 0;
+	if (taps / L > DECIMATOR_MAX_PHASE_TAPS) return 0;
+	if (channels == 0 || channels > DECIMATOR_MAX_CHANNELS) return 0;
+
+	fir->coeffs = coeffs;
+	fir->phase_taps = taps / L;
+	fir->L = L;
+	fir->M = M;
+	fir->channels = channels;
+	return 1;
+}
+
+
+uint16_t Decimator_fir_q15_process(Decimator_fir_q15_t *fir, const int16_t *in, uint16_t frames, int16_t *out) {
+	uint16_t produced = 0;
+	uint16_t P = fir->phase_taps;
+
+	for (uint16_t n = 0; n < frames; n++) {
+		//!< История хранится дважды подряд, поэтому последние P отсчетов всегда лежат непрерывно начиная с pos
+		fir->pos = fir->pos ? fir->pos - 1 : P - 1;
+		for (uint8_t ch = 0; ch < fir->channels; ch++) {
+			int16_t x = in[n * fir->channels + ch];
+			fir->history[ch][fir->pos] = x;
+			fir->history[ch][fir->pos + P] = x;
+		}
+
+		//!< Входной отсчет открывает L позиций сетки интерполяции. Выходные отсчеты идут по ней с шагом M,
+		//!< и для каждого вычисляется только фаза phase: коэффициенты h[phase], h[phase + L], ...
+		while (fir->phase < fir->L) {
+			const int16_t *h = fir->coeffs + fir->phase;
+			for (uint8_t ch = 0; ch < fir->channels; ch++) {
+				const int16_t *x = &fir->history[ch][fir->pos];
+				int64_t acc = 0;
+				for (uint16_t j = 0; j < P; j++) {
+					acc += (int32_t)h[j * fir->L] * x[j];
+				}
+				out[produced * fir->channels + ch] = __Decimator_saturate((int32_t)((acc + (1 << 14)) >> 15));
+			}
+			produced++;
+			fir->phase += fir->M;
+		}
+		fir->phase -= fir->L;
+	}
+
+	return produced;
+}
+
+
+uint8_t Decimator_fir_f32_init(Decimator_fir_f32_t *fir, const float *coeffs, uint16_t taps, uint8_t L, uint8_t M, uint8_t channels) {
+	memset(fir, 0, sizeof(Decimator_fir_f32_t));
+
+	if (L == 0 || M == 0 || taps == 0 || taps % L) return 0;
+	if (taps / L > DECIMATOR_MAX_PHASE_TAPS) return 0;
+	if (channels == 0 || channels > DECIMATOR_MAX_CHANNELS) return 0;
+
+	fir->coeffs = coeffs;
+	fir->phase_taps = taps / L;
+	fir->L = L;
+	fir->M = M;
+	fir->channels = channels;
+	return 1;
+}
+
+
+uint16_t Decimator_fir_f32_process(Decimator_fir_f32_t *fir, const float *in, uint16_t frames, float *out) {
+	uint16_t produced = 0;
+	uint16_t P = fir->phase_taps;
+
+	for (uint16_t n = 0; n < frames; n++) {
+		fir->pos = fir->pos ? fir->pos - 1 : P - 1;
+		for (uint8_t ch = 0; ch < fir->channels; ch++) {
+			float x = in[n * fir->channels + ch];
+			fir->history[ch][fir->pos] = x;
+			fir->history[ch][fir->pos + P] = x;
+		}
+
+		while (fir->phase < fir->L) {
+			const float *h = fir->coeffs + fir->phase;
+			for (uint8_t ch = 0; ch < fir->channels; ch++) {
+				const float *x = &fir->history[ch][fir->pos];
+				float acc = 0.0f;
+				for (uint16_t j = 0; j < P; j++) {
+					acc += h[j * fir->L] * x[j];
+				}
+				out[produced * fir->channels + ch] = acc;
+			}
+			produced++;
+			fir->phase += fir->M;
+		}
+		fir->phase -= fir->L;
+	}
+
+	return produced;
+}
+
+
+uint8_t Decimator_biquad_f32_init(Decimator_biquad_f32_t *bq, const float *coeffs, uint8_t sections, uint8_t M, uint8_t channels) {
+	memset(bq, 0, sizeof(Decimator_biquad_f32_t));
+
+	if (sections == 0 || sections > DECIMATOR_MAX_SECTIONS || M == 0) return 0;
+	if (channels == 0 || channels > DECIMATOR_MAX_CHANNELS) return 0;
+
+	bq->coeffs = coeffs;
+	bq->sections = sections;
+	bq->M = M;
+	bq->channels = channels;
+	return 1;
+}
+
+
+uint16_t Decimator_biquad_f32_process(Decimator_biquad_f32_t *bq, const float *in, uint16_t frames, float *out) {
+	uint16_t produced = 0;
+
+	for (uint16_t n = 0; n < frames; n++) {
+		uint8_t emit = ++bq->count >= bq->M;
+		if (emit) bq->count = 0;
+
+		for (uint8_t ch = 0; ch < bq->channels; ch++) {
+			float x = in[n * bq->channels + ch];
+
+			//!< Транспонированная вторая прямая форма: два элемента состояния на звено
+			for (uint8_t k = 0; k < bq->sections; k++) {
+				const float *c = &bq->coeffs[k * 5];
+				float *s = bq->state[ch][k];
+				float y = c[0] * x + s[0];
+				s[0] = c[1] * x - c[3] * y + s[1];
+				s[1] = c[2] * x - c[4] * y;
+				x = y;
+			}
+
+			if (emit) out[produced * bq->channels + ch] = x;
+		}
+		if (emit) produced++;
+	}
+
+	return produced;
+}
@@ -0,0 +1,252 @@
+/**
+ * @defgroup Decimator
+ * @brief Прореживание измерений инерциального датчика с подавлением наложения спектров. Работает блоками из FIFO.
+ * @details Цепочка собирается из трех звеньев, каждое из которых можно использовать отдельно:
+ * 	- CIC фильтр - целочисленное прореживание в целое число раз без умножений;
+ * 	- полифазный КИХ фильтр с передискретизацией в L/M раз, вычисляющий только нужные выходные отсчеты;
+ * 	- каскад биквадратных звеньев с прореживанием в M раз.
+ *
+ * 	CIC фильтр целочисленный, КИХ фильтр есть в вариантах Q15 и float, биквады - в варианте float.
+ * 	Целочисленные варианты принимают и возвращают значения датчика, поэтому результат переводится в физические
+ * 	единицы функциями @ref LSM6DS33_A_convert и аналогичными.
+ * 	Данные всех звеньев - чередующиеся каналы: x, y, z гироскопа и акселерометра в порядке FIFO.
+ *
+ * 	Например, из FIFO с частотой 1666 Гц точные 250 Гц получаются так: CIC второго порядка прореживает в 2 раза
+ * 	до 833 Гц, затем КИХ фильтр передискретизирует в 3/10 раза.
+ * 	\code{.c}
+ * 	Decimator_cic_t cic;
+ * 	Decimator_fir_q15_t fir;
+ * 	int16_t h[93];
+ * 	Decimator_cic_init(&cic, 2, 2, 6);
+ * 	Decimator_design_q15(h, 93, 80.0f / 2500.0f, 3);		// 833 Гц * 3 = 2500 Гц до прореживания
+ * 	Decimator_fir_q15_init(&fir, h, 93, 3, 10, 6);
+ *
+ * 	uint16_t n = Decimator_cic_process(&cic, fifo, samples, block);
+ * 	n = Decimator_fir_q15_process(&fir, block, n, out);
+ * 	\endcode
+ *
+ * 	Модуль не зависит от HAL и собирается на ПК: АЧХ и скорость приведенной цепочки проверяются программой
+ * 	Decimator_benchmark.c.
+ */
+/**
+ * @file Decimator.h
+ * @ingroup Decimator
+ * @brief API фильтров прореживания
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef DECIMATOR_H_
+#define DECIMATOR_H_
+
+#include <stdint.h>
+
+#define DECIMATOR_MAX_CHANNELS				6			//!< Максимальное количество чередующихся каналов
+#define DECIMATOR_CIC_MAX_ORDER				4			//!< Максимальный порядок CIC фильтра
+#define DECIMATOR_MAX_PHASE_TAPS			64			//!< Максимальное количество коэффициентов КИХ фильтра на одну фазу
+#define DECIMATOR_MAX_SECTIONS				4			//!< Максимальное количество биквадратных звеньев
+
+/** @cond UNNECESSARY */
+#define DECIMATOR_PI						3.14159265f
+/** @endcond */
+
+/**
+ * @brief Состояние CIC фильтра
+ */
+typedef struct {
+	/** @cond UNNECESSARY */
+	uint32_t integrator[DECIMATOR_MAX_CHANNELS][DECIMATOR_CIC_MAX_ORDER];
+	uint32_t comb[DECIMATOR_MAX_CHANNELS][DECIMATOR_CIC_MAX_ORDER];
+	uint32_t gain;
+	/** @endcond */
+	uint8_t order;					//!< Порядок фильтра
+	uint8_t ratio;					//!< Коэффициент прореживания
+	uint8_t channels;				//!< Количество каналов
+	uint8_t count;					//!< Количество входных отсчетов с последнего выходного
+} Decimator_cic_t;
+
+/**
+ * @brief Состояние полифазного КИХ фильтра в формате Q15
+ */
+typedef struct {
+	/** @cond UNNECESSARY */
+	const int16_t *coeffs;
+	int16_t history[DECIMATOR_MAX_CHANNELS][2 * DECIMATOR_MAX_PHASE_TAPS];
+	/** @endcond */
+	uint16_t phase_taps;			//!< Количество коэффициентов на одну фазу
+	uint16_t pos;					//!< Позиция последнего входного отсчета в истории
+	uint16_t phase;					//!< Фаза следующего выходного отсчета
+	uint8_t L;						//!< Коэффициент интерполяции
+	uint8_t M;						//!< Коэффициент прореживания
+	uint8_t channels;				//!< Количество каналов
+} Decimator_fir_q15_t;
+
+/**
+ * @brief Состояние полифазного КИХ фильтра в формате float
+ */
+typedef struct {
+	/** @cond UNNECESSARY */
+	const float *coeffs;
+	float history[DECIMATOR_MAX_CHANNELS][2 * DECIMATOR_MAX_PHASE_TAPS];
+	/** @endcond */
+	uint16_t phase_taps;			//!< Количество коэффициентов на одну фазу
+	uint16_t pos;					//!< Позиция последнего входного отсчета в истории
+	uint16_t phase;					//!< Фаза следующего выходного отсчета
+	uint8_t L;						//!< Коэффициент интерполяции
+	uint8_t M;						//!< Коэффициент прореживания
+	uint8_t channels;				//!< Количество каналов
+} Decimator_fir_f32_t;
+
+/**
+ * @brief Состояние каскада биквадратных звеньев в формате float
+ */
+typedef struct {
+	/** @cond UNNECESSARY */
+	const float *coeffs;
+	float state[DECIMATOR_MAX_CHANNELS][DECIMATOR_MAX_SECTIONS][2];
+	/** @endcond */
+	uint8_t sections;				//!< Количество звеньев
+	uint8_t M;						//!< Коэффициент прореживания
+	uint8_t channels;				//!< Количество каналов
+	uint8_t count;					//!< Количество входных отсчетов с последнего выходного
+} Decimator_biquad_f32_t;
+
+/**
+ * @brief Инициализация CIC фильтра
+ * @ingroup Decimator
+ * @details Коэффициент усиления ratio^order компенсируется, поэтому выход имеет тот же масштаб, что и вход.
+ * 	Завал АЧХ CIC фильтра в полосе пропускания при необходимости компенсируется следующим КИХ фильтром.
+ *
+ * @param[out] cic Состояние фильтра
+ * @param[in] order Порядок фильтра, от 1 до @ref DECIMATOR_CIC_MAX_ORDER
+ * @param[in] ratio Коэффициент прореживания. ratio^order не должен превышать 65536
+ * @param[in] channels Количество каналов, от 1 до @ref DECIMATOR_MAX_CHANNELS
+ * @return uint8_t 1, если параметры допустимы, иначе 0
+ */
+uint8_t Decimator_cic_init(Decimator_cic_t *cic, uint8_t order, uint8_t ratio, uint8_t channels);
+
+/**
+ * @brief Обработка блока CIC фильтром
+ * @ingroup Decimator
+ * @details Вход и выход могут совпадать.
+ *
+ * @param[in,out] cic Состояние фильтра
+ * @param[in] in Входные отсчеты, frames * channels значений
+ * @param[in] frames Количество входных отсчетов каждого канала
+ * @param[out] out Выходные отсчеты
+ * @return uint16_t Количество выходных отсчетов каждого канала
+ */
+uint16_t Decimator_cic_process(Decimator_cic_t *cic, const int16_t *in, uint16_t frames, int16_t *out);
+
+/**
+ * @brief Расчет коэффициентов КИХ фильтра нижних частот
+ * @ingroup Decimator
+ * @details Окно Хэмминга. Коэффициент передачи на нулевой частоте равен L, что компенсирует вставку нулей при интерполяции.
+ *
+ * @param[out] h Коэффициенты фильтра
+ * @param[in] taps Количество коэффициентов, кратное L
+ * @param[in] cutoff Частота среза относительно частоты после интерполяции (входная частота * L), от 0 до 0.5
+ * @param[in] L Коэффициент интерполяции
+ */
+void Decimator_design_f32(float *h, uint16_t taps, float cutoff, uint8_t L);
+
+/**
+ * @brief Расчет коэффициентов КИХ фильтра нижних частот в формате Q15
+ * @ingroup Decimator
+ * @details Аналог @ref Decimator_design_f32.
+ *
+ * @param[out] h Коэффициенты фильтра
+ * @param[in] taps Количество коэффициентов, кратное L
+ * @param[in] cutoff Частота среза относительно частоты после интерполяции, от 0 до 0.5
+ * @param[in] L Коэффициент интерполяции
+ */
+void Decimator_design_q15(int16_t *h, uint16_t taps, float cutoff, uint8_t L);
+
+/**
+ * @brief Инициализация полифазного КИХ фильтра Q15
+ * @ingroup Decimator
+ * @details Частота выходных отсчетов равна входной частоте * L / M. Коэффициенты не копируются.
+ *
+ * @param[out] fir Состояние фильтра
+ * @param[in] coeffs Коэффициенты фильтра в формате Q15
+ * @param[in] taps Количество коэффициентов, кратное L, не более L * @ref DECIMATOR_MAX_PHASE_TAPS
+ * @param[in] L Коэффициент интерполяции
+ * @param[in] M Коэффициент прореживания
+ * @param[in] channels Количество каналов, от 1 до @ref DECIMATOR_MAX_CHANNELS
+ * @return uint8_t 1, если параметры допустимы, иначе 0
+ */
+uint8_t Decimator_fir_q15_init(Decimator_fir_q15_t *fir, const int16_t *coeffs, uint16_t taps, uint8_t L, uint8_t M, uint8_t channels);
+
+/**
+ * @brief Обработка блока полифазным КИХ фильтром Q15
+ * @ingroup Decimator
+ * @details Для каждого выходного отсчета вычисляется только одна фаза фильтра: taps / L умножений на канал.
+ * 	Выход насыщается до диапазона int16_t. Вход и выход могут совпадать, если L не больше M.
+ *
+ * @param[in,out] fir Состояние фильтра
+ * @param[in] in Входные отсчеты, frames * channels значений
+ * @param[in] frames Количество входных отсчетов каждого канала
+ * @param[out] out Выходные отсчеты, не более frames * L / M + 1 на канал
+ * @return uint16_t Количество выходных отсчетов каждого канала
+ */
+uint16_t Decimator_fir_q15_process(Decimator_fir_q15_t *fir, const int16_t *in, uint16_t frames, int16_t *out);
+
+/**
+ * @brief Инициализация полифазного КИХ фильтра float
+ * @ingroup Decimator
+ * @details Аналог @ref Decimator_fir_q15_init.
+ *
+ * @param[out] fir Состояние фильтра
+ * @param[in] coeffs Коэффициенты фильтра
+ * @param[in] taps Количество коэффициентов, кратное L, не более L * @ref DECIMATOR_MAX_PHASE_TAPS
+ * @param[in] L Коэффициент интерполяции
+ * @param[in] M Коэффициент прореживания
+ * @param[in] channels Количество каналов, от 1 до @ref DECIMATOR_MAX_CHANNELS
+ * @return uint8_t 1, если параметры допустимы, иначе 0
+ */
+uint8_t Decimator_fir_f32_init(Decimator_fir_f32_t *fir, const float *coeffs, uint16_t taps, uint8_t L, uint8_t M, uint8_t channels);
+
+/**
+ * @brief Обработка блока полифазным КИХ фильтром float
+ * @ingroup Decimator
+ * @details Аналог @ref Decimator_fir_q15_process. Принимает значения в физических единицах, например из @ref LSM6DS33_FIFO_drain.
+ *
+ * @param[in,out] fir Состояние фильтра
+ * @param[in] in Входные отсчеты, frames * channels значений
+ * @param[in] frames Количество входных отсчетов каждого канала
+ * @param[out] out Выходные отсчеты, не более frames * L / M + 1 на канал
+ * @return uint16_t Количество выходных отсчетов каждого канала
+ */
+uint16_t Decimator_fir_f32_process(Decimator_fir_f32_t *fir, const float *in, uint16_t frames, float *out);
+
+/**
+ * @brief Инициализация каскада биквадратных звеньев
+ * @ingroup Decimator
+ * @details Каждое звено задается пятью коэффициентами b0, b1, b2, a1, a2 (a0 = 1):
+ * 	y = b0 * x + b1 * x[-1] + b2 * x[-2] - a1 * y[-1] - a2 * y[-2]. Коэффициенты не копируются.
+ * 	БИХ фильтр требует меньше умножений, чем КИХ, но вносит неравномерную групповую задержку.
+ *
+ * @param[out] bq Состояние фильтра
+ * @param[in] coeffs Коэффициенты звеньев, 5 * sections значений
+ * @param[in] sections Количество звеньев, от 1 до @ref DECIMATOR_MAX_SECTIONS
+ * @param[in] M Коэффициент прореживания
+ * @param[in] channels Количество каналов, от 1 до @ref DECIMATOR_MAX_CHANNELS
+ * @return uint8_t 1, если параметры допустимы, иначе 0
+ */
+uint8_t Decimator_biquad_f32_init(Decimator_biquad_f32_t *bq, const float *coeffs, uint8_t sections, uint8_t M, uint8_t channels);
+
+/**
+ * @brief Обработка блока каскадом биквадратных звеньев
+ * @ingroup Decimator
+ * @details Фильтр обрабатывает каждый входной отсчет, на выход передается каждый M-й. Вход и выход могут совпадать.
+ *
+ * @param[in,out] bq Состояние фильтра
+ * @param[in] in Входные отсчеты, frames * channels значений
+ * @param[in] frames Количество входных отсчетов каждого канала
+ * @param[out] out Выходные отсчеты
+ * @return uint16_t Количество выходных отсчетов каждого канала
+ */
+uint16_t Decimator_biquad_f32_process(Decimator_biquad_f32_t *bq, const float *in, uint16_t frames, float *out);
+
+#endif /* DECIMATOR_H_ */
@@ -0,0 +1,164 @@
+/**
+ * @file Decimator_benchmark.c
+ * @ingroup Decimator
+ * @brief Проверка АЧХ и скорости цепочки прореживания 1666 -> 250 Гц на ПК
+ * @details Программа для ПК, в прошивку не входит: без макроса DECIMATOR_BENCHMARK файл пустой. Сборка и запуск:
+ * 	\code
+ * 	gcc -O2 -DDECIMATOR_BENCHMARK Decimator_benchmark.c Decimator.c -lm -o Decimator_benchmark
+ * 	./Decimator_benchmark
+ * 	\endcode
+ * 	Цепочка та же, что в примере модуля: CIC второго порядка /2, затем КИХ фильтр 3/10 на 93 коэффициента.
+ * 	АЧХ измеряется по амплитуде установившегося синуса на выходе, скорость - в кадрах по 6 каналов на входе цепочки,
+ * 	блоками по 32 кадра, как из FIFO датчика.
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifdef DECIMATOR_BENCHMARK
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "Decimator.h"
+
+#define DECIMATOR_BENCHMARK_RATE		1666.667	//!< Частота входных отсчетов в Гц
+#define DECIMATOR_BENCHMARK_FRAMES		16640		//!< Количество входных кадров: около 10 с, кратно размеру блока
+#define DECIMATOR_BENCHMARK_BLOCK		32			//!< Размер блока в кадрах
+#define DECIMATOR_BENCHMARK_REPEATS		200			//!< Количество проходов для замера скорости
+#define DECIMATOR_BENCHMARK_TAPS		93			//!< Количество коэффициентов КИХ фильтра
+#define DECIMATOR_BENCHMARK_AMPLITUDE	10000		//!< Амплитуда тестового синуса
+
+int16_t Decimator_benchmark_in[DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_MAX_CHANNELS];
+int16_t Decimator_benchmark_mid[DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_MAX_CHANNELS];
+int16_t Decimator_benchmark_out[DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_MAX_CHANNELS];
+float Decimator_benchmark_in_f32[DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_MAX_CHANNELS];
+float Decimator_benchmark_out_f32[DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_MAX_CHANNELS];
+
+//!< Биквад Баттерворта второго порядка с частотой среза 0.1 от входной частоты
+const float Decimator_benchmark_biquad[5] = { 0.0675f, 0.135f, 0.0675f, -1.143f, 0.4128f };
+
+
+double __Decimator_benchmark_seconds(clock_t start) {
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+double __Decimator_benchmark_response(double frequency, uint8_t q15, double *rate) {
+	Decimator_cic_t cic;
+	Decimator_fir_q15_t fir;
+	Decimator_fir_f32_t fir_f32;
+	int16_t h[DECIMATOR_BENCHMARK_TAPS];
+	float h_f32[DECIMATOR_BENCHMARK_TAPS];
+
+	//!< 833 Гц * 3 = 2500 Гц до прореживания, срез 80 Гц
+	Decimator_cic_init(&cic, 2, 2, 1);
+	Decimator_design_q15(h, DECIMATOR_BENCHMARK_TAPS, 80.0f / 2500.0f, 3);
+	Decimator_fir_q15_init(&fir, h, DECIMATOR_BENCHMARK_TAPS, 3, 10, 1);
+	Decimator_design_f32(h_f32, DECIMATOR_BENCHMARK_TAPS, 80.0f / 2500.0f, 3);
+	Decimator_fir_f32_init(&fir_f32, h_f32, DECIMATOR_BENCHMARK_TAPS, 3, 10, 1);
+
+	for (uint32_t i = 0; i < DECIMATOR_BENCHMARK_FRAMES; i++) {
+		Decimator_benchmark_in[i] = (int16_t)(DECIMATOR_BENCHMARK_AMPLITUDE * sin(2 * M_PI * frequency * i / DECIMATOR_BENCHMARK_RATE));
+	}
+
+	uint16_t n = Decimator_cic_process(&cic, Decimator_benchmark_in, DECIMATOR_BENCHMARK_FRAMES, Decimator_benchmark_mid);
+	uint16_t m;
+	if (q15) {
+		m = Decimator_fir_q15_process(&fir, Decimator_benchmark_mid, n, Decimator_benchmark_out);
+	}
+	else {
+		for (uint16_t i = 0; i < n; i++) {
+			Decimator_benchmark_in_f32[i] = Decimator_benchmark_mid[i];
+		}
+		m = Decimator_fir_f32_process(&fir_f32, Decimator_benchmark_in_f32, n, Decimator_benchmark_out_f32);
+	}
+	*rate = m * DECIMATOR_BENCHMARK_RATE / DECIMATOR_BENCHMARK_FRAMES;
+
+	//!< Первая половина выхода отбрасывается, чтобы переходный процесс не попал в амплитуду
+	double peak = 0;
+	for (uint16_t i = m / 2; i < m; i++) {
+		double value = fabs(q15 ? Decimator_benchmark_out[i] : Decimator_benchmark_out_f32[i]);
+		if (value > peak) {
+			peak = value;
+		}
+	}
+
+	return peak / DECIMATOR_BENCHMARK_AMPLITUDE;
+}
+
+
+void __Decimator_benchmark_frequency(void) {
+	const double frequencies[] = { 10, 50, 80, 125, 170, 250, 400, 700 };
+	double rate;
+
+	for (uint8_t i = 0; i < sizeof(frequencies) / sizeof(frequencies[0]); i++) {
+		double q15 = __Decimator_benchmark_response(frequencies[i], 1, &rate);
+		double f32 = __Decimator_benchmark_response(frequencies[i], 0, &rate);
+		printf("response %5.0f Hz: q15 %.4f (%6.1f dB), f32 %.4f\n", frequencies[i], q15, 20 * log10(q15 > 1e-6 ? q15 : 1e-6), f32);
+	}
+	printf("output rate: %.1f Hz\n", rate);
+}
+
+
+void __Decimator_benchmark_speed(void) {
+	Decimator_cic_t cic;
+	Decimator_fir_q15_t fir;
+	Decimator_fir_f32_t fir_f32;
+	Decimator_biquad_f32_t biquad;
+	int16_t h[DECIMATOR_BENCHMARK_TAPS];
+	float h_f32[DECIMATOR_BENCHMARK_TAPS];
+	const uint8_t channels = 6;
+
+	Decimator_cic_init(&cic, 2, 2, channels);
+	Decimator_design_q15(h, DECIMATOR_BENCHMARK_TAPS, 80.0f / 2500.0f, 3);
+	Decimator_fir_q15_init(&fir, h, DECIMATOR_BENCHMARK_TAPS, 3, 10, channels);
+	Decimator_design_f32(h_f32, DECIMATOR_BENCHMARK_TAPS, 80.0f / 2500.0f, 3);
+	Decimator_fir_f32_init(&fir_f32, h_f32, DECIMATOR_BENCHMARK_TAPS, 3, 10, channels);
+	Decimator_biquad_f32_init(&biquad, Decimator_benchmark_biquad, 1, 2, channels);
+
+	for (uint32_t i = 0; i < DECIMATOR_BENCHMARK_FRAMES * channels; i++) {
+		Decimator_benchmark_in[i] = (int16_t)(i * 7919 % 20000 - 10000);
+		Decimator_benchmark_in_f32[i] = Decimator_benchmark_in[i];
+	}
+
+	//!< Количество выходных кадров выводится, чтобы компилятор не выбросил вычисления
+	const double frames = (double)DECIMATOR_BENCHMARK_FRAMES * DECIMATOR_BENCHMARK_REPEATS;
+	uint32_t total = 0;
+	clock_t start = clock();
+	for (uint32_t r = 0; r < DECIMATOR_BENCHMARK_REPEATS; r++) {
+		for (uint32_t b = 0; b < DECIMATOR_BENCHMARK_FRAMES; b += DECIMATOR_BENCHMARK_BLOCK) {
+			uint16_t n = Decimator_cic_process(&cic, &Decimator_benchmark_in[b * channels], DECIMATOR_BENCHMARK_BLOCK, Decimator_benchmark_mid);
+			total += Decimator_fir_q15_process(&fir, Decimator_benchmark_mid, n, Decimator_benchmark_out);
+		}
+	}
+	printf("CIC + q15 FIR: %.1f M frames/s (%u out)\n", frames / __Decimator_benchmark_seconds(start) * 1e-6, total);
+
+	total = 0;
+	start = clock();
+	for (uint32_t r = 0; r < DECIMATOR_BENCHMARK_REPEATS; r++) {
+		for (uint32_t b = 0; b < DECIMATOR_BENCHMARK_FRAMES; b += DECIMATOR_BENCHMARK_BLOCK) {
+			total += Decimator_fir_f32_process(&fir_f32, &Decimator_benchmark_in_f32[b * channels], DECIMATOR_BENCHMARK_BLOCK, Decimator_benchmark_out_f32);
+		}
+	}
+	printf("f32 FIR 3/10: %.1f M frames/s (%u out)\n", frames / __Decimator_benchmark_seconds(start) * 1e-6, total);
+
+	total = 0;
+	start = clock();
+	for (uint32_t r = 0; r < DECIMATOR_BENCHMARK_REPEATS; r++) {
+		for (uint32_t b = 0; b < DECIMATOR_BENCHMARK_FRAMES; b += DECIMATOR_BENCHMARK_BLOCK) {
+			total += Decimator_biquad_f32_process(&biquad, &Decimator_benchmark_in_f32[b * channels], DECIMATOR_BENCHMARK_BLOCK, Decimator_benchmark_out_f32);
+		}
+	}
+	printf("f32 biquad /2: %.1f M frames/s (%u out)\n", frames / __Decimator_benchmark_seconds(start) * 1e-6, total);
+}
+
+
+int main(void) {
+	__Decimator_benchmark_frequency();
+	__Decimator_benchmark_speed();
+
+	return 0;
+}
+
+#endif /* DECIMATOR_BENCHMARK */
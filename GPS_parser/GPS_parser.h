@@ -9,6 +9,7 @@
  * @defgroup Parser_group GPS parser
  * @brief			Модуль парсера NMEA сообщений
  * @details 		Предполагается использование модуля на ПК, а не на МК. Модуль позволяет извлекать данные из NMEA сообщений типа GGA и VTG в формате "hh:mm:ss  $GPxxx,x,x,x,x,x,x,x*xx". 
+ * 					Для приема и разбора сообщений на МК используется модуль @ref GPS_uart с потоковым декодером @ref NMEA_stream.
  * 					Пример использования кода
  * 					\code{.c}  
  * 					char* buffer = new char[256];
@@ -0,0 +1,87 @@
+#include "GPS_uart.h"
+
+UART_HandleTypeDef *GPS_huart;
+uint8_t GPS_rx_buffer[GPS_RX_BUFFER_SIZE];
+NMEA_stream_t GPS_nmea;
+
+uint16_t GPS_read_pos;
+volatile uint8_t GPS_ready;
+volatile uint32_t GPS_GGA_tick;
+volatile uint32_t GPS_VTG_tick;
+
+
+HAL_StatusTypeDef GPS_init(UART_HandleTypeDef *huart_) {
+	GPS_huart = huart_;
+	GPS_read_pos = 0;
+	GPS_ready = 0;
+	NMEA_stream_init(&GPS_nmea);
+
+	//!< В режиме Circular DMA не останавливается после заполнения буфера, а HAL вызывает RxEventCallback 
+	//!< по паузе на линии, на половине и в конце буфера с текущей позицией записи
+	return HAL_UARTEx_ReceiveToIdle_DMA(GPS_huart, GPS_rx_buffer, GPS_RX_BUFFER_SIZE);
+}
+
+
+uint8_t GPS_rx_event(uint16_t write_pos) {
+	uint8_t ready = NMEA_stream_ring(&GPS_nmea, GPS_rx_buffer, GPS_RX_BUFFER_SIZE, &GPS_read_pos, write_pos);
+
+	if (ready & NMEA_READY_GGA) {
+		GPS_GGA_tick = HAL_GetTick();
+	}
+	if (ready & NMEA_READY_VTG) {
+		GPS_VTG_tick = HAL_GetTick();
+	}
+	GPS_ready |= ready;
+
+	return ready;
+}
+
+
+HAL_StatusTypeDef GPS_error_event(void) {
+	//!< При ошибке в режиме DMA HAL уже остановил прием, но при шуме или ошибке кадра прием может продолжаться.
+	//!< Останавливаем его в любом случае, чтобы позиция записи DMA гарантированно началась с нуля
+	HAL_UART_AbortReceive(GPS_huart);
+	__HAL_UART_CLEAR_OREFLAG(GPS_huart);
+	__HAL_UART_CLEAR_NEFLAG(GPS_huart);
+	__HAL_UART_CLEAR_FEFLAG(GPS_huart);
+	__HAL_UART_CLEAR_PEFLAG(GPS_huart);
+
+	//!< Сообщение, в котором произошла ошибка, не будет дописано: декодер ждет начала следующего
+	if (GPS_nmea.state != NMEA_STATE_IDLE) {
+		GPS_nmea.errors++;
+		GPS_nmea.state = NMEA_STATE_IDLE;
+	}
+	GPS_read_pos = 0;
+
+	return HAL_UARTEx_ReceiveToIdle_DMA(GPS_huart, GPS_rx_buffer, GPS_RX_BUFFER_SIZE);
+}
+
+
+uint8_t GPS_get_GGA(NMEA_GGA_t *GGA, uint32_t *tick) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	*GGA = GPS_nmea.GGA;
+	*tick = GPS_GGA_tick;
+	uint8_t ready = GPS_ready & NMEA_READY_GGA;
+	GPS_ready &= ~NMEA_READY_GGA;
+
+	__set_PRIMASK(primask);
+
+	return ready != 0;
+}
+
+
+uint8_t GPS_get_VTG(NMEA_VTG_t *VTG, uint32_t *tick) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	*VTG = GPS_nmea.VTG;
+	*tick = GPS_VTG_tick;
+	uint8_t ready = GPS_ready & NMEA_READY_VTG;
+	GPS_ready &= ~NMEA_READY_VTG;
+
+	__set_PRIMASK(primask);
+
+	return ready != 0;
+}
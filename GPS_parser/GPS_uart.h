@@ -0,0 +1,103 @@
+/**
+ * @defgroup GPS_uart GPS UART
+ * @brief Прием NMEA сообщений с GPS на МК через UART в кольцевой буфер DMA с детектированием паузы на линии (IDLE).
+ * @details DMA принимает байты в кольцевой буфер @ref GPS_rx_buffer без участия процессора. Прерывание приходит
+ * 	при паузе на линии после сообщения, а также на половине и в конце буфера. В прерывании новые байты передаются
+ * 	потоковому декодеру @ref NMEA_stream прямо из буфера DMA, поэтому решение доступно сразу после приема последнего байта.
+ *
+ * 	DMA канал приема UART должен быть настроен в CubeMX в режиме Circular. Пример использования:
+ * 	\code{.c}
+ * 	GPS_init(&huart2);
+ *
+ * 	void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+ * 		if (huart == GPS_huart) GPS_rx_event(Size);
+ * 	}
+ *
+ * 	void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+ * 		if (huart == GPS_huart) GPS_error_event();
+ * 	}
+ *
+ * 	NMEA_GGA_t fix;
+ * 	uint32_t tick;
+ * 	if (GPS_get_GGA(&fix, &tick)) { ... }
+ * 	\endcode
+ *
+ * 	При использовании LL прерывание IDLE обрабатывается пользователем, а в @ref GPS_rx_event передается
+ * 	позиция записи DMA: GPS_RX_BUFFER_SIZE - LL_DMA_GetDataLength(...).
+ */
+/**
+ * @file GPS_uart.h
+ * @ingroup GPS_uart
+ * @brief API приема NMEA сообщений по UART DMA
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef GPS_UART_H_
+#define GPS_UART_H_
+
+#include "main.h"
+#include "NMEA_stream.h"
+
+#define GPS_RX_BUFFER_SIZE				256			//!< Размер кольцевого буфера DMA. Должен вмещать данные, приходящие между прерываниями
+
+extern UART_HandleTypeDef *GPS_huart;				//!< Экземпляр UART, к которому подключен GPS
+extern uint8_t GPS_rx_buffer[GPS_RX_BUFFER_SIZE];	//!< Кольцевой буфер, в который DMA записывает принятые байты
+extern NMEA_stream_t GPS_nmea;						//!< Состояние декодера. Содержит последние принятые записи
+
+/**
+ * @brief Запуск приема данных с GPS
+ * @ingroup GPS_uart
+ * @details Запускает прием в кольцевой буфер DMA с прерыванием по паузе на линии.
+ *
+ * @param[in] huart_ Экземпляр UART, к которому подключен GPS
+ * @return HAL_StatusTypeDef Результат запуска приема
+ */
+HAL_StatusTypeDef GPS_init(UART_HandleTypeDef *huart_);
+
+/**
+ * @brief Обработка новых данных в буфере DMA
+ * @ingroup GPS_uart
+ * @details Вызывается из HAL_UARTEx_RxEventCallback. Передает декодеру байты, принятые с прошлого вызова, без копирования.
+ * 	Время обработки запоминается для каждой обновленной записи.
+ *
+ * @param[in] write_pos Позиция записи DMA в буфере (аргумент Size в HAL_UARTEx_RxEventCallback)
+ * @return uint8_t Флаги @ref NMEA_READY записей, обновленных во время вызова
+ */
+uint8_t GPS_rx_event(uint16_t write_pos);
+
+/**
+ * @brief Восстановление приема после ошибки UART
+ * @ingroup GPS_uart
+ * @details Вызывается из HAL_UART_ErrorCallback. После ошибки переполнения, кадра или шума HAL прерывает прием DMA,
+ * 	и без перезапуска данные с GPS больше не поступают. Функция сбрасывает флаги ошибок, отбрасывает недопринятое
+ * 	сообщение и заново запускает прием с начала буфера. Последние корректные записи декодера сохраняются.
+ *
+ * @return HAL_StatusTypeDef Результат перезапуска приема
+ */
+HAL_StatusTypeDef GPS_error_event(void);
+
+/**
+ * @brief Получение последнего сообщения GGA
+ * @ingroup GPS_uart
+ * @details Копирует запись с запретом прерываний, чтобы она не изменилась во время копирования.
+ *
+ * @param[out] GGA Последнее корректное сообщение GGA
+ * @param[out] tick Время приема сообщения в мс (HAL_GetTick)
+ * @return uint8_t 1, если с прошлого вызова пришло новое сообщение, иначе 0
+ */
+uint8_t GPS_get_GGA(NMEA_GGA_t *GGA, uint32_t *tick);
+
+/**
+ * @brief Получение последнего сообщения VTG
+ * @ingroup GPS_uart
+ * @details Копирует запись с запретом прерываний, чтобы она не изменилась во время копирования.
+ *
+ * @param[out] VTG Последнее корректное сообщение VTG
+ * @param[out] tick Время приема сообщения в мс (HAL_GetTick)
+ * @return uint8_t 1, если с прошлого вызова пришло новое сообщение, иначе 0
+ */
+uint8_t GPS_get_VTG(NMEA_VTG_t *VTG, uint32_t *tick);
+
+#endif /* GPS_UART_H_ */
@@ -0,0 +1,237 @@
+#include "NMEA_stream.h"
+
+#define NMEA_ADDRESS(A, B, C) 		(((uint32_t)(A) << 16) | ((uint32_t)(B) << 8) | (uint32_t)(C))
+
+
+int32_t __NMEA_rescale(int32_t value, uint8_t fraction, uint8_t target) {
+	while (fraction < target) {
+		value *= 10;
+		fraction++;
+	}
+	while (fraction > target) {
+		value /= 10;
+		fraction--;
+	}
+	return value;
+}
+
+
+int32_t __NMEA_coordinate(int32_t value, uint8_t fraction) {
+	//!< Координата передается в формате (d)ddmm.mmmmm. Приводим к 5 знакам после точки, чтобы уложиться в int32_t
+	value = __NMEA_rescale(value, fraction, 5);
+
+	int32_t degrees = value / 10000000;
+	int32_t minutes = value % 10000000;
+
+	//!< minutes хранит минуты * 1e5, а результат нужен в градусах * 1e7: minutes * 100 / 60
+	return degrees * 10000000 + minutes * 5 / 3;
+}
+
+
+int8_t __NMEA_hex(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+
+void __NMEA_field_end(NMEA_stream_t *nmea) {
+	int32_t value = (nmea->flags & NMEA_FLAG_NEGATIVE) ? -nmea->value : nmea->value;
+
+	if (nmea->field == 0) {
+		//!< Тип сообщения определяется по последним трем символам адреса, чтобы принимать GP, GN, GL и т.д.
+		switch (nmea->address & 0xFFFFFF) {
+			case NMEA_ADDRESS('G', 'G', 'A'):
+				nmea->type = NMEA_TYPE_GGA;
+				nmea->GGA_work = (NMEA_GGA_t){0};
+				break;
+			case NMEA_ADDRESS('V', 'T', 'G'):
+				nmea->type = NMEA_TYPE_VTG;
+				nmea->VTG_work = (NMEA_VTG_t){0};
+				break;
+			default:
+				nmea->type = NMEA_TYPE_UNKNOWN;
+				break;
+		}
+	}
+	else if (nmea->type == NMEA_TYPE_GGA) {
+		switch (nmea->field) {
+			case 1: nmea->GGA_work.time = __NMEA_rescale(value, nmea->fraction, 2); break;
+			case 2: nmea->GGA_work.latitude = __NMEA_coordinate(value, nmea->fraction); break;
+			case 3: if (nmea->symbol == 'S') nmea->GGA_work.latitude = -nmea->GGA_work.latitude; break;
+			case 4: nmea->GGA_work.longitude = __NMEA_coordinate(value, nmea->fraction); break;
+			case 5: if (nmea->symbol == 'W') nmea->GGA_work.longitude = -nmea->GGA_work.longitude; break;
+			case 6: nmea->GGA_work.solve_type = (uint8_t)value; break;
+			case 7: nmea->GGA_work.sats = (uint8_t)value; break;
+			case 8: nmea->GGA_work.HDOP = (uint16_t)__NMEA_rescale(value, nmea->fraction, 2); break;
+			case 9: nmea->GGA_work.altitude = __NMEA_rescale(value, nmea->fraction, 3); break;
+		}
+	}
+	else if (nmea->type == NMEA_TYPE_VTG) {
+		switch (nmea->field) {
+			case 1: nmea->VTG_work.course = __NMEA_rescale(value, nmea->fraction, 2); break;
+			case 5: nmea->VTG_work.speed_kn = __NMEA_rescale(value, nmea->fraction, 3); break;
+			case 7: nmea->VTG_work.speed_kmh = __NMEA_rescale(value, nmea->fraction, 3); break;
+			//!< Индикатор режима (NMEA 2.3+). 'N' - данные недействительны
+			case 9: if (nmea->symbol == 'N') nmea->type = NMEA_TYPE_UNKNOWN; break;
+		}
+	}
+
+	nmea->field++;
+	nmea->value = 0;
+	nmea->fraction = 0;
+	nmea->flags = 0;
+	nmea->symbol = 0;
+}
+
+
+uint8_t __NMEA_commit(NMEA_stream_t *nmea) {
+	if (nmea->rx_checksum != nmea->checksum) {
+		nmea->errors++;
+		return 0;
+	}
+
+	if (nmea->type == NMEA_TYPE_GGA) {
+		//!< Сообщение без решения не публикуем, как и в parse()
+		if (nmea->GGA_work.solve_type == 0) {
+			nmea->errors++;
+			return 0;
+		}
+		nmea->GGA = nmea->GGA_work;
+		return NMEA_READY_GGA;
+	}
+	else if (nmea->type == NMEA_TYPE_VTG) {
+		nmea->VTG = nmea->VTG_work;
+		return NMEA_READY_VTG;
+	}
+
+	return 0;
+}
+
+
+void NMEA_stream_init(NMEA_stream_t *nmea) {
+	*nmea = (NMEA_stream_t){0};
+	nmea->state = NMEA_STATE_IDLE;
+}
+
+
+uint8_t NMEA_stream_feed(NMEA_stream_t *nmea, const uint8_t *data, uint16_t size) {
+	uint8_t ready = 0;
+
+	for (uint16_t i = 0; i < size; i++) {
+		char c = (char)data[i];
+
+		//!< '$' всегда начинает новое сообщение. Если предыдущее не закончилось - оно потеряно
+		if (c == '$') {
+			if (nmea->state != NMEA_STATE_IDLE) {
+				nmea->errors++;
+			}
+			nmea->state = NMEA_STATE_BODY;
+			nmea->type = NMEA_TYPE_UNKNOWN;
+			nmea->field = 0;
+			nmea->length = 1;
+			nmea->checksum = 0;
+			nmea->address = 0;
+			nmea->value = 0;
+			nmea->fraction = 0;
+			nmea->flags = 0;
+			nmea->symbol = 0;
+			continue;
+		}
+
+		if (nmea->state == NMEA_STATE_IDLE) {
+			continue;
+		}
+
+		if (++nmea->length > NMEA_MAX_SENTENCE_LENGTH) {
+			nmea->errors++;
+			nmea->state = NMEA_STATE_IDLE;
+			continue;
+		}
+
+		if (nmea->state == NMEA_STATE_CHECKSUM) {
+			int8_t digit = __NMEA_hex(c);
+			if (digit < 0) {
+				nmea->errors++;
+				nmea->state = NMEA_STATE_IDLE;
+			}
+			else if (!(nmea->flags & NMEA_FLAG_CHECKSUM_LOW)) {
+				nmea->rx_checksum = digit << 4;
+				nmea->flags |= NMEA_FLAG_CHECKSUM_LOW;
+			}
+			else {
+				//!< Запись публикуется сразу после последнего символа контрольной суммы, не дожидаясь CR LF
+				nmea->rx_checksum |= digit;
+				ready |= __NMEA_commit(nmea);
+				nmea->state = NMEA_STATE_IDLE;
+			}
+			continue;
+		}
+
+		if (c == '*') {
+			__NMEA_field_end(nmea);
+			nmea->state = NMEA_STATE_CHECKSUM;
+			continue;
+		}
+
+		if (c == '\r' || c == '\n') {
+			//!< Конец строки без контрольной суммы
+			nmea->errors++;
+			nmea->state = NMEA_STATE_IDLE;
+			continue;
+		}
+
+		nmea->checksum ^= (uint8_t)c;
+
+		if (c == ',') {
+			__NMEA_field_end(nmea);
+		}
+		else if (c >= '0' && c <= '9') {
+			if (nmea->flags & NMEA_FLAG_POINT) {
+				//!< Лишние знаки после точки отбрасываем, чтобы значение поместилось в int32_t
+				if (nmea->fraction < NMEA_MAX_FRACTION_DIGITS) {
+					nmea->value = nmea->value * 10 + (c - '0');
+					nmea->fraction++;
+				}
+			}
+			else if (nmea->value < 214748364) {
+				nmea->value = nmea->value * 10 + (c - '0');
+			}
+		}
+		else if (c == '.') {
+			nmea->flags |= NMEA_FLAG_POINT;
+		}
+		else if (c == '-') {
+			nmea->flags |= NMEA_FLAG_NEGATIVE;
+		}
+		else {
+			nmea->symbol = c;
+			nmea->address = (nmea->address << 8) | (uint8_t)c;
+		}
+	}
+
+	return ready;
+}
+
+
+uint8_t NMEA_stream_ring(NMEA_stream_t *nmea, const uint8_t *ring, uint16_t ring_size, uint16_t *read_pos, uint16_t write_pos) {
+	uint8_t ready = 0;
+	uint16_t pos = *read_pos;
+
+	//!< По завершении передачи DMA позиция записи равна размеру буфера, что соответствует его началу
+	if (write_pos >= ring_size) {
+		write_pos = 0;
+	}
+
+	//!< Данные переходят через конец буфера - разбираем хвост буфера, затем его начало
+	if (write_pos < pos) {
+		ready |= NMEA_stream_feed(nmea, ring + pos, ring_size - pos);
+		pos = 0;
+	}
+	ready |= NMEA_stream_feed(nmea, ring + pos, write_pos - pos);
+
+	*read_pos = write_pos;
+
+	return ready;
+}
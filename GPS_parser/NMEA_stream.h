@@ -0,0 +1,141 @@
+/**
+ * @defgroup NMEA_stream NMEA stream
+ * @brief Потоковый декодер NMEA сообщений для работы на МК. Не выделяет память и не копирует принятые байты.
+ * @details В отличие от @ref Parser_group, декодер разбирает сообщение побайтно по мере поступления данных,
+ * 	поэтому ему можно передавать произвольные куски потока, в том числе разорванные на границе кольцевого буфера DMA.
+ * 	Контрольная сумма и значения полей вычисляются на лету, после приема контрольной суммы запись публикуется
+ * 	в @ref NMEA_stream_t::GGA или @ref NMEA_stream_t::VTG.
+ *
+ * 	Модуль не зависит от HAL, поэтому его можно собрать и проверить на ПК, подавая байты из записанного лога:
+ * 	\code{.c}
+ * 	NMEA_stream_t nmea;
+ * 	NMEA_stream_init(&nmea);
+ * 	if (NMEA_stream_feed(&nmea, buffer, size) & NMEA_READY_GGA) {
+ * 		printf("%ld %ld\n", nmea.GGA.latitude, nmea.GGA.longitude);
+ * 	}
+ * 	\endcode
+ */
+/**
+ * @file NMEA_stream.h
+ * @ingroup NMEA_stream
+ * @brief API потокового декодера NMEA сообщений
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef NMEA_STREAM_H_
+#define NMEA_STREAM_H_
+
+#include <stdint.h>
+
+/**
+ * @defgroup NMEA_READY
+ * @ingroup NMEA_stream
+ * @brief Флаги, возвращаемые @ref NMEA_stream_feed. Показывают, какие записи были обновлены.
+ * @{
+ */
+#define NMEA_READY_GGA						0b01		//!< Получено корректное сообщение GGA
+#define NMEA_READY_VTG						0b10		//!< Получено корректное сообщение VTG
+/** @} */
+
+/** @cond UNNECESSARY */
+#define NMEA_MAX_SENTENCE_LENGTH			82			//!< Максимальная длина сообщения по стандарту NMEA 0183
+#define NMEA_MAX_FRACTION_DIGITS			5
+
+#define NMEA_STATE_IDLE						0
+#define NMEA_STATE_BODY						1
+#define NMEA_STATE_CHECKSUM					2
+
+#define NMEA_TYPE_UNKNOWN					0
+#define NMEA_TYPE_GGA						1
+#define NMEA_TYPE_VTG						2
+
+#define NMEA_FLAG_POINT						0b001
+#define NMEA_FLAG_NEGATIVE					0b010
+#define NMEA_FLAG_CHECKSUM_LOW				0b100
+/** @endcond */
+
+/**
+ * @brief Данные сообщения GGA в целочисленном виде
+ */
+typedef struct {
+	uint32_t time;			//!< Время UTC в формате hhmmss с точностью до сотых секунды (hhmmss * 100 + сотые)
+	int32_t latitude;		//!< Широта в 1e-7 градуса. Южная широта отрицательна
+	int32_t longitude;		//!< Долгота в 1e-7 градуса. Западная долгота отрицательна
+	int32_t altitude;		//!< Высота над уровнем моря в мм
+	uint16_t HDOP;			//!< Геометрический фактор, умноженный на 100
+	uint8_t solve_type;		//!< Тип решения
+	uint8_t sats;			//!< Количество найденных спутников
+} NMEA_GGA_t;
+
+/**
+ * @brief Данные сообщения VTG в целочисленном виде
+ */
+typedef struct {
+	uint32_t course;		//!< Истинный курс в сотых долях градуса
+	uint32_t speed_kn;		//!< Скорость в тысячных долях узла
+	uint32_t speed_kmh;		//!< Скорость в м/ч
+} NMEA_VTG_t;
+
+/**
+ * @brief Состояние потокового декодера
+ */
+typedef struct {
+	NMEA_GGA_t GGA;			//!< Последнее корректное сообщение GGA
+	NMEA_VTG_t VTG;			//!< Последнее корректное сообщение VTG
+	uint32_t errors;		//!< Количество отброшенных сообщений (ошибка контрольной суммы, длины или отсутствие решения)
+
+	/** @cond UNNECESSARY */
+	NMEA_GGA_t GGA_work;
+	NMEA_VTG_t VTG_work;
+	int32_t value;
+	uint32_t address;
+	uint8_t state;
+	uint8_t type;
+	uint8_t field;
+	uint8_t length;
+	uint8_t checksum;
+	uint8_t rx_checksum;
+	uint8_t fraction;
+	uint8_t flags;
+	char symbol;
+	/** @endcond */
+} NMEA_stream_t;
+
+/**
+ * @brief Инициализация декодера
+ * @ingroup NMEA_stream
+ *
+ * @param[out] nmea Состояние декодера
+ */
+void NMEA_stream_init(NMEA_stream_t *nmea);
+
+/**
+ * @brief Разбор очередного куска потока
+ * @ingroup NMEA_stream
+ * @details Байты разбираются на месте, без копирования. Сообщение может быть разорвано между вызовами произвольным образом.
+ *
+ * @param[in,out] nmea Состояние декодера
+ * @param[in] data Указатель на начало куска потока
+ * @param[in] size Количество байт
+ * @return uint8_t Флаги @ref NMEA_READY записей, обновленных во время вызова
+ */
+uint8_t NMEA_stream_feed(NMEA_stream_t *nmea, const uint8_t *data, uint16_t size);
+
+/**
+ * @brief Разбор новых данных из кольцевого буфера
+ * @ingroup NMEA_stream
+ * @details Передает декодеру байты между позицией чтения и позицией записи. Если данные переходят через конец буфера,
+ * 	декодеру передаются два куска: до конца буфера и от его начала. Позиция чтения сдвигается на позицию записи.
+ *
+ * @param[in,out] nmea Состояние декодера
+ * @param[in] ring Кольцевой буфер
+ * @param[in] ring_size Размер кольцевого буфера в байтах
+ * @param[in,out] read_pos Позиция, с которой начинаются еще не разобранные данные
+ * @param[in] write_pos Позиция, на которую будет записан следующий принятый байт
+ * @return uint8_t Флаги @ref NMEA_READY записей, обновленных во время вызова
+ */
+uint8_t NMEA_stream_ring(NMEA_stream_t *nmea, const uint8_t *ring, uint16_t ring_size, uint16_t *read_pos, uint16_t write_pos);
+
+#endif /* NMEA_STREAM_H_ */
@@ -11,143 +11,553 @@
 
 #include "LIS3MDL_Registers.h"
 #include "LIS3MDL.h"
+#include <string.h>
+#include <math.h>
 
-/* I2C R/W Function Prototypes */
-static HAL_StatusTypeDef writeByte(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t data);
-static HAL_StatusTypeDef readByte(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t *data);
-static HAL_StatusTypeDef readMultiBytes(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t *data, uint16_t count);
+/* Helper Function Prototypes */
+static HAL_StatusTypeDef writeControl(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, const uint8_t *ctrl);
+static void convertMag(LIS3MDL_t *hsensor, const uint8_t *data);
+static void convertTemp(LIS3MDL_t *hsensor, const uint8_t *data);
+static void convertMagInt(LIS3MDL_t *hsensor, const uint8_t *data);
+static void updateScale(LIS3MDL_t *hsensor);
+static void updateCalibration(LIS3MDL_Calibration_t *cal, const LIS3MDL_t *hsensor);
+static int solveLinear(double a[9][9], double *b, int n);
+static void symmetricEigen(double a[3][3], double v[3][3]);
+#ifdef LIS3MDL_HAL
+static void startStreamRead(LIS3MDL_Stream_t *stream);
+#endif /* LIS3MDL_HAL */
 
 /* Sensor Functions */
-LIS3MDL_Result_t LIS3MDL_Init(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c, LIS3MDL_Device_t dev, LIS3MDL_Scale_t scale, LIS3MDL_OperationMode_t mode, LIS3MDL_ODR_t odr)
+LIS3MDL_Result_t LIS3MDL_Init(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Device_t dev, LIS3MDL_Scale_t scale, LIS3MDL_OperationMode_t mode, LIS3MDL_ODR_t odr)
 {
-    uint8_t data;
+    uint8_t data = 0x00;
     hsensor->addr = (uint8_t)(dev << 1);
     hsensor->scale = (LIS3MDL_Scale_t)scale;
+    updateScale(hsensor);
 
-    if (HAL_I2C_IsDeviceReady(hi2c, (uint16_t)hsensor->addr, 2, 5) != HAL_OK)
-        if (HAL_I2C_IsDeviceReady(hi2c, ((uint16_t)hsensor->addr) + 1, 2, 5) != HAL_OK)
-            return LIS3MDL_ERROR;
+    if (I2C_Mem_Read(hi2c, hsensor->addr, WHO_AM_I, &data, 1, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+    if (data != WHO_AM_I_VALUE)
+        return LIS3MDL_ERROR;
 
-    readByte(hi2c, hsensor->addr, WHO_AM_I, &data);
-    if (data != 0x3D)
+    /* The whole control image is built locally from the reset values, no read-modify-write on the bus */
+    uint8_t ctrl[5];
+    ctrl[0] = CTRL_REG1_TEMP_EN | ((uint8_t)mode << 5) | (uint8_t)odr;
+    ctrl[1] = (uint8_t)scale;
+    ctrl[2] = 0x00;                     /* Continuous-conversion mode */
+    ctrl[3] = (uint8_t)(mode << 2);     /* Z axis operating mode */
+    ctrl[4] = CTRL_REG5_BDU;            /* Output registers are not updated until both bytes of the sample are read */
+
+    if (writeControl(hsensor, hi2c, ctrl) != HAL_OK)
         return LIS3MDL_ERROR;
+
     data = 0x00;
+    if (I2C_Mem_Write(hi2c, hsensor->addr, INT_CFG, &data, 1, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
 
-    readByte(hi2c, hsensor->addr, CTRL_REG1, &data);
-    data &= ~0xFE;
-    data |= 0x80 | ((uint8_t)mode << 5) | (uint8_t)odr;
-    writeByte(hi2c, hsensor->addr, CTRL_REG1, data);
+    return LIS3MDL_OK;
+}
 
-    readByte(hi2c, hsensor->addr, CTRL_REG2, &data);
-    data &= ~0x60;
-    data |= (uint8_t)scale;
-    writeByte(hi2c, hsensor->addr, CTRL_REG2, data);
+LIS3MDL_Result_t LIS3MDL_ReadMag(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c)
+{
+    uint8_t data[6];
 
-    readByte(hi2c, hsensor->addr, CTRL_REG3, &data);
-    data &= ~0x03;
-    data |= 0x00;
-    writeByte(hi2c, hsensor->addr, CTRL_REG3, data);
+    if (I2C_Mem_Read(hi2c, hsensor->addr, OUT_X_L | AUTO_INCREMENT, data, 6, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
 
-    readByte(hi2c, hsensor->addr, CTRL_REG4, &data);
-    data &= ~0x0C;
-    data |= (uint8_t)(mode << 2);
-    writeByte(hi2c, hsensor->addr, CTRL_REG4, data);
+    convertMag(hsensor, data);
 
-    readByte(hi2c, hsensor->addr, CTRL_REG5, &data);
-    data &= ~0xC0;
-    data |= 0x00;
-    writeByte(hi2c, hsensor->addr, CTRL_REG5, data);
+    return LIS3MDL_OK;
+}
 
-    readByte(hi2c, hsensor->addr, INT_CFG, &data);
-    data &= ~0xFF;
-    data |= 0x00;
-    writeByte(hi2c, hsensor->addr, INT_CFG, data);
+LIS3MDL_Result_t LIS3MDL_ReadMagInt(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c)
+{
+    uint8_t data[6];
+
+    if (I2C_Mem_Read(hi2c, hsensor->addr, OUT_X_L | AUTO_INCREMENT, data, 6, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+
+    convertMagInt(hsensor, data);
 
     return LIS3MDL_OK;
 }
 
-LIS3MDL_Result_t LIS3MDL_ReadMag(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c)
+LIS3MDL_Result_t LIS3MDL_ReadTemp(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c)
 {
-    uint8_t data[6];
+    uint8_t data[2];
+    
+    if (I2C_Mem_Read(hi2c, hsensor->addr, TEMP_OUT_L | AUTO_INCREMENT, data, 2, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+
+    convertTemp(hsensor, data);
+
+    return LIS3MDL_OK;
+}
+
+LIS3MDL_Result_t LIS3MDL_ReadMagTemp(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c)
+{
+    uint8_t data[8];
+
+    /* OUT_X_L..TEMP_OUT_H are contiguous, so one repeated-start transaction returns the whole sample */
+    if (I2C_Mem_Read(hi2c, hsensor->addr, OUT_X_L | AUTO_INCREMENT, data, 8, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+
+    convertMag(hsensor, data);
+    convertTemp(hsensor, &data[6]);
+
+    return LIS3MDL_OK;
+}
+
+LIS3MDL_Result_t LIS3MDL_Save(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Snapshot_t *snapshot)
+{
+    memset(snapshot, 0, sizeof(LIS3MDL_Snapshot_t));
+
+    if (I2C_Mem_Read(hi2c, hsensor->addr, CTRL_REG1 | AUTO_INCREMENT, snapshot->ctrl, 5, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+    if (I2C_Mem_Read(hi2c, hsensor->addr, INT_CFG, &snapshot->int_cfg, 1, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+    snapshot->scale = (uint8_t)hsensor->scale;
+
+    Snapshot_seal(snapshot, sizeof(LIS3MDL_Snapshot_t), WHO_AM_I_VALUE, hsensor->addr);
+
+    return LIS3MDL_OK;
+}
+
+LIS3MDL_Result_t LIS3MDL_Restore(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, const LIS3MDL_Snapshot_t *snapshot)
+{
+    uint8_t id = 0;
+
+    if (I2C_Mem_Read(hi2c, snapshot->header.address, WHO_AM_I, &id, 1, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+    if (!Snapshot_check(snapshot, sizeof(LIS3MDL_Snapshot_t), id))
+        return LIS3MDL_ERROR;
+
+    hsensor->addr = snapshot->header.address;
+    hsensor->scale = (LIS3MDL_Scale_t)snapshot->scale;
+    updateScale(hsensor);
+
+    if (writeControl(hsensor, hi2c, snapshot->ctrl) != HAL_OK)
+        return LIS3MDL_ERROR;
+    if (I2C_Mem_Write(hi2c, hsensor->addr, INT_CFG, (uint8_t *)&snapshot->int_cfg, 1, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+
+    return LIS3MDL_OK;
+}
+
+/* Batch Conversion Functions */
+void LIS3MDL_ConvertSamples(const LIS3MDL_t *hsensor, const LIS3MDL_Sample_t *samples, float (*mag)[3], uint16_t count)
+{
+    float lsb = hsensor->gauss_per_lsb;
+
+    for (uint16_t n = 0; n < count; n++) {
+        mag[n][0] = samples[n].mag_raw[0] * lsb;
+        mag[n][1] = samples[n].mag_raw[1] * lsb;
+        mag[n][2] = samples[n].mag_raw[2] * lsb;
+    }
+}
+
+void LIS3MDL_ConvertSamplesInt(const LIS3MDL_t *hsensor, const LIS3MDL_Sample_t *samples, int32_t (*mag)[3], uint16_t count)
+{
+    int32_t lsb = hsensor->mgauss_per_lsb;
+    int32_t half = 1 << (LIS3MDL_MGAUSS_Q - 1);
+
+    for (uint16_t n = 0; n < count; n++) {
+        mag[n][0] = (samples[n].mag_raw[0] * lsb + half) >> LIS3MDL_MGAUSS_Q;
+        mag[n][1] = (samples[n].mag_raw[1] * lsb + half) >> LIS3MDL_MGAUSS_Q;
+        mag[n][2] = (samples[n].mag_raw[2] * lsb + half) >> LIS3MDL_MGAUSS_Q;
+    }
+}
+
+/* Calibration Functions */
+void LIS3MDL_CalibReset(LIS3MDL_CalibAccum_t *acc)
+{
+    memset(acc, 0, sizeof(LIS3MDL_CalibAccum_t));
+}
+
+void LIS3MDL_CalibAdd(LIS3MDL_CalibAccum_t *acc, const float *mag)
+{
+    double x = mag[0], y = mag[1], z = mag[2];
+
+    /* General quadric x'Qx + 2u'x = 1, one row of the least squares design matrix */
+    double d[9] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+
+    for (int i = 0; i < 9; i++) {
+        for (int j = i; j < 9; j++)
+            acc->ata[i][j] += d[i] * d[j];
+        acc->atb[i] += d[i];
+    }
+    acc->count++;
+}
+
+LIS3MDL_Result_t LIS3MDL_CalibSolve(const LIS3MDL_CalibAccum_t *acc, LIS3MDL_Calibration_t *cal)
+{
+    double a[9][9], p[9];
+
+    if (acc->count < LIS3MDL_CALIB_MIN_SAMPLES)
+        return LIS3MDL_ERROR;
+
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 9; j++)
+            a[i][j] = j >= i ? acc->ata[i][j] : acc->ata[j][i];
+        p[i] = acc->atb[i];
+    }
+    if (!solveLinear(a, p, 9))
+        return LIS3MDL_ERROR;
+
+    double q[3][3] = {{p[0], p[3], p[4]}, {p[3], p[1], p[5]}, {p[4], p[5], p[2]}};
+    double u[3] = {p[6], p[7], p[8]};
+
+    /* Center c = -Q^-1 u, then (x - c)'Q(x - c) = 1 + c'Qc */
+    double m[9][9], c[9];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            m[i][j] = q[i][j];
+        c[i] = -u[i];
+    }
+    if (!solveLinear(m, c, 3))
+        return LIS3MDL_ERROR;
+
+    double k = 1.0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            k += c[i] * q[i][j] * c[j];
+    if (k <= 0.0)
+        return LIS3MDL_ERROR;
+
+    /* Q/k = V diag(l) V', the semi-axes are 1/sqrt(l) */
+    double v[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            q[i][j] /= k;
+    symmetricEigen(q, v);
+    if (q[0][0] <= 0.0 || q[1][1] <= 0.0 || q[2][2] <= 0.0)
+        return LIS3MDL_ERROR;
+
+    /* W = R * V diag(sqrt(l)) V' maps the ellipsoid onto a sphere with the geometric mean radius R */
+    double field = pow(q[0][0] * q[1][1] * q[2][2], -1.0 / 6.0);
+    double s[3] = {sqrt(q[0][0]) * field, sqrt(q[1][1]) * field, sqrt(q[2][2]) * field};
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+            cal->matrix[i][j] = (float)(v[i][0] * s[0] * v[j][0] + v[i][1] * s[1] * v[j][1] + v[i][2] * s[2] * v[j][2]);
+        cal->offset[i] = (float)c[i];
+        cal->hw_offset[i] = 0.0f;
+    }
+    cal->field = (float)field;
+
+    /* Force recomputation of the fused coefficients on the next conversion */
+    cal->scale = (LIS3MDL_Scale_t)0xFF;
+
+    return LIS3MDL_OK;
+}
+
+void LIS3MDL_ApplyCalibration(const LIS3MDL_t *hsensor, LIS3MDL_Calibration_t *cal, const int16_t *raw, float *out)
+{
+    if (cal->scale != hsensor->scale)
+        updateCalibration(cal, hsensor);
 
-    readMultiBytes(hi2c, hsensor->addr, OUT_X_L, data, 6);
+    for (int i = 0; i < 3; i++)
+        out[i] = cal->gain[i][0] * raw[0] + cal->gain[i][1] * raw[1] + cal->gain[i][2] * raw[2] - cal->bias[i];
+}
+
+LIS3MDL_Result_t LIS3MDL_WriteOffset(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Calibration_t *cal)
+{
+    uint8_t data[6] = {0};
+    float counts = 1.0f / hsensor->gauss_per_lsb;
+
+    /* The sensor subtracts OFFSET_x_REG from every output, in output counts of the current scale */
+    for (int i = 0; cal && i < 3; i++) {
+        float value = cal->offset[i] * counts;
+        int16_t offset = (int16_t)(value < 0 ? value - 0.5f : value + 0.5f);
+        data[2 * i] = (uint8_t)offset;
+        data[2 * i + 1] = (uint8_t)((uint16_t)offset >> 8);
+        cal->hw_offset[i] = offset / counts;
+    }
+
+    if (I2C_Mem_Write(hi2c, hsensor->addr, OFFSET_X_REG_L_M | AUTO_INCREMENT, data, 6, LIS3MDL_TIMEOUT) != HAL_OK)
+        return LIS3MDL_ERROR;
+
+    if (cal)
+        updateCalibration(cal, hsensor);
+
+    return LIS3MDL_OK;
+}
+
+#ifdef LIS3MDL_HAL
+/* Streaming Functions */
+__weak uint32_t LIS3MDL_Timestamp(void)
+{
+    return HAL_GetTick();
+}
+
+LIS3MDL_Result_t LIS3MDL_StartStream(LIS3MDL_Stream_t *stream, LIS3MDL_t *hsensor, I2C_TypeDef *hi2c)
+{
+    memset(stream, 0, sizeof(LIS3MDL_Stream_t));
+    stream->hsensor = hsensor;
+    stream->hi2c = hi2c;
+
+    LIS3MDL_DRDY_Callback(stream);
+
+    return stream->busy ? LIS3MDL_OK : LIS3MDL_ERROR;
+}
+
+void LIS3MDL_DRDY_Callback(LIS3MDL_Stream_t *stream)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* An edge during a read in flight is served right after it completes */
+    stream->edge_time = LIS3MDL_Timestamp();
+    stream->pending = 1;
+    startStreamRead(stream);
+
+    __set_PRIMASK(primask);
+}
+
+void LIS3MDL_I2C_Callback(LIS3MDL_Stream_t *stream)
+{
+    if (!stream->busy) {
+        /* Another driver's transfer on the shared bus: the buffer holds no new sample, but a deferred read may start now */
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        startStreamRead(stream);
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    uint16_t head = stream->head;
+    uint16_t next = (head + 1) & (LIS3MDL_STREAM_SIZE - 1);
+    const uint8_t *data = stream->buffer;
+
+    if (data[0] & STATUS_ZYXOR)
+        stream->overruns++;
+
+    /* The ring is written only here and read only in LIS3MDL_ReadStream, so no locking is needed */
+    if (next == stream->tail) {
+        stream->dropped++;
+    } else {
+        LIS3MDL_Sample_t *sample = &stream->ring[head];
+        sample->time = stream->read_time;
+        sample->status = data[0];
+        sample->mag_raw[0] = ((int16_t)data[2] << 8) | data[1];
+        sample->mag_raw[1] = ((int16_t)data[4] << 8) | data[3];
+        sample->mag_raw[2] = ((int16_t)data[6] << 8) | data[5];
+        sample->temp_raw = ((int16_t)data[8] << 8) | data[7];
+        stream->head = next;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    stream->busy = 0;
+    startStreamRead(stream);
+    __set_PRIMASK(primask);
+}
+
+void LIS3MDL_I2C_ErrorCallback(LIS3MDL_Stream_t *stream)
+{
+    /* Errors of other drivers' transfers are not ours to handle */
+    if (!stream->busy)
+        return;
+
+    /* No retry from the interrupt: a persistent bus fault would otherwise loop here */
+    stream->busy = 0;
+    stream->pending = 1;
+}
+
+uint16_t LIS3MDL_ReadStream(LIS3MDL_Stream_t *stream, LIS3MDL_Sample_t *samples, uint16_t max)
+{
+    uint16_t count = 0;
+    uint16_t tail = stream->tail;
+
+    while (count < max && tail != stream->head) {
+        samples[count++] = stream->ring[tail];
+        tail = (tail + 1) & (LIS3MDL_STREAM_SIZE - 1);
+    }
+    stream->tail = tail;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    startStreamRead(stream);
+    __set_PRIMASK(primask);
+
+    return count;
+}
+
+static void startStreamRead(LIS3MDL_Stream_t *stream)
+{
+    /* Called with interrupts masked. STATUS_REG..TEMP_OUT_H in one burst, so the overrun flag comes with the sample */
+    if (stream->busy || !stream->pending)
+        return;
+
+    if (HAL_I2C_Mem_Read_IT(stream->hi2c, stream->hsensor->addr, STATUS_REG | AUTO_INCREMENT, I2C_MEMADD_SIZE_8BIT, stream->buffer, 9) == HAL_OK) {
+        stream->busy = 1;
+        stream->pending = 0;
+        stream->read_time = stream->edge_time;
+    }
+}
+#endif /* LIS3MDL_HAL */
+
+/* Helper Functions */
+static HAL_StatusTypeDef writeControl(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, const uint8_t *ctrl)
+{
+    uint8_t image[5];
+    uint8_t readback[5];
+
+    /* CTRL_REG1..CTRL_REG5 in one auto-increment burst, then one burst read to verify the image */
+    memcpy(image, ctrl, sizeof(image));
+    if (I2C_Mem_Write(hi2c, hsensor->addr, CTRL_REG1 | AUTO_INCREMENT, image, 5, LIS3MDL_TIMEOUT) != HAL_OK)
+        return HAL_ERROR;
+    if (I2C_Mem_Read(hi2c, hsensor->addr, CTRL_REG1 | AUTO_INCREMENT, readback, 5, LIS3MDL_TIMEOUT) != HAL_OK)
+        return HAL_ERROR;
+
+    return memcmp(image, readback, sizeof(image)) == 0 ? HAL_OK : HAL_ERROR;
+}
+
+static void convertMag(LIS3MDL_t *hsensor, const uint8_t *data)
+{
+    hsensor->mag_raw[0] = ((int16_t)data[1] << 8) | data[0];
+    hsensor->mag_raw[1] = ((int16_t)data[3] << 8) | data[2];
+    hsensor->mag_raw[2] = ((int16_t)data[5] << 8) | data[4];
+
+    hsensor->mag[0] = hsensor->mag_raw[0] * hsensor->gauss_per_lsb;
+    hsensor->mag[1] = hsensor->mag_raw[1] * hsensor->gauss_per_lsb;
+    hsensor->mag[2] = hsensor->mag_raw[2] * hsensor->gauss_per_lsb;
+}
+
+static void convertMagInt(LIS3MDL_t *hsensor, const uint8_t *data)
+{
+    int32_t half = 1 << (LIS3MDL_MGAUSS_Q - 1);
 
     hsensor->mag_raw[0] = ((int16_t)data[1] << 8) | data[0];
     hsensor->mag_raw[1] = ((int16_t)data[3] << 8) | data[2];
     hsensor->mag_raw[2] = ((int16_t)data[5] << 8) | data[4];
 
+    hsensor->mag_mgauss[0] = (hsensor->mag_raw[0] * hsensor->mgauss_per_lsb + half) >> LIS3MDL_MGAUSS_Q;
+    hsensor->mag_mgauss[1] = (hsensor->mag_raw[1] * hsensor->mgauss_per_lsb + half) >> LIS3MDL_MGAUSS_Q;
+    hsensor->mag_mgauss[2] = (hsensor->mag_raw[2] * hsensor->mgauss_per_lsb + half) >> LIS3MDL_MGAUSS_Q;
+}
+
+static void updateScale(LIS3MDL_t *hsensor)
+{
+    /* The only place where the sensitivity is looked up and divided, the read paths just multiply */
+    float lsb_per_gauss;
+
     switch (hsensor->scale) {
-        case LIS3MDL_Scale_4G:
-            *hsensor->mag_x = (float)(hsensor->mag_raw[0] / 6842.0f);
-            *hsensor->mag_y = (float)(hsensor->mag_raw[1] / 6842.0f);
-            *hsensor->mag_z = (float)(hsensor->mag_raw[2] / 6842.0f);
-            break;
         case LIS3MDL_Scale_8G:
-            *hsensor->mag_x = (float)(hsensor->mag_raw[0] / 3421.0f);
-            *hsensor->mag_y = (float)(hsensor->mag_raw[1] / 3421.0f);
-            *hsensor->mag_z = (float)(hsensor->mag_raw[2] / 3421.0f);
+            lsb_per_gauss = 3421.0f;
             break;
         case LIS3MDL_Scale_12G:
-            *hsensor->mag_x = (float)(hsensor->mag_raw[0] / 2281.0f);
-            *hsensor->mag_y = (float)(hsensor->mag_raw[1] / 2281.0f);
-            *hsensor->mag_z = (float)(hsensor->mag_raw[2] / 2281.0f);
+            lsb_per_gauss = 2281.0f;
             break;
         case LIS3MDL_Scale_16G:
-            *hsensor->mag_x = (float)(hsensor->mag_raw[0] / 1711.0f);
-            *hsensor->mag_y = (float)(hsensor->mag_raw[1] / 1711.0f);
-            *hsensor->mag_z = (float)(hsensor->mag_raw[2] / 1711.0f);
+            lsb_per_gauss = 1711.0f;
+            break;
+        default:
+            lsb_per_gauss = 6842.0f;
             break;
     }
-    return LIS3MDL_OK;
+
+    hsensor->gauss_per_lsb = 1.0f / lsb_per_gauss;
+    hsensor->mgauss_per_lsb = (int32_t)(1000.0f * (1 << LIS3MDL_MGAUSS_Q) / lsb_per_gauss + 0.5f);
 }
 
-LIS3MDL_Result_t LIS3MDL_ReadTemp(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c)
+static void updateCalibration(LIS3MDL_Calibration_t *cal, const LIS3MDL_t *hsensor)
 {
-    uint8_t data[2];
-    
-    readMultiBytes(hi2c, hsensor->addr, TEMP_OUT_L, data, 2);
-
-    hsensor->temp_raw = ((int16_t)data[1] << 8) | data[0];
-    hsensor->temp = (float)(hsensor->temp_raw / 8.0f);
+    float lsb = hsensor->gauss_per_lsb;
 
-    return LIS3MDL_OK;
+    /* W * (raw * lsb - (offset - hw_offset)) = (W * lsb) * raw - W * (offset - hw_offset) */
+    for (int i = 0; i < 3; i++) {
+        cal->bias[i] = 0.0f;
+        for (int j = 0; j < 3; j++) {
+            cal->gain[i][j] = cal->matrix[i][j] * lsb;
+            cal->bias[i] += cal->matrix[i][j] * (cal->offset[j] - cal->hw_offset[j]);
+        }
+    }
+    cal->scale = hsensor->scale;
 }
 
-/* I2C R/W Functions */
-static HAL_StatusTypeDef writeByte(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t data)
+static int solveLinear(double a[9][9], double *b, int n)
 {
-    uint8_t buffer[2];
-    buffer[0] = register_addr;
-    buffer[1] = data;
-    if (HAL_I2C_Master_Transmit(hi2c, (uint16_t)device_addr, (uint8_t *)buffer, 2, 1000) != HAL_OK) {
-        if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_AF) {}
-        return HAL_ERROR;
+    /* Gaussian elimination with partial pivoting, the solution replaces b */
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++)
+            if (fabs(a[row][col]) > fabs(a[pivot][col]))
+                pivot = row;
+        if (fabs(a[pivot][col]) < 1e-12)
+            return 0;
+
+        if (pivot != col) {
+            for (int j = 0; j < n; j++) {
+                double t = a[col][j];
+                a[col][j] = a[pivot][j];
+                a[pivot][j] = t;
+            }
+            double t = b[col];
+            b[col] = b[pivot];
+            b[pivot] = t;
+        }
+
+        for (int row = col + 1; row < n; row++) {
+            double f = a[row][col] / a[col][col];
+            for (int j = col; j < n; j++)
+                a[row][j] -= f * a[col][j];
+            b[row] -= f * b[col];
+        }
     }
-    return HAL_OK;
+
+    for (int row = n - 1; row >= 0; row--) {
+        for (int j = row + 1; j < n; j++)
+            b[row] -= a[row][j] * b[j];
+        b[row] /= a[row][row];
+    }
+    return 1;
 }
 
-static HAL_StatusTypeDef readByte(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t *data)
+static void symmetricEigen(double a[3][3], double v[3][3])
 {
-    if (HAL_I2C_Master_Transmit(hi2c, (uint16_t)device_addr, &register_addr, 1, 1000) != HAL_OK) {
-        if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_AF) {}
-        return HAL_ERROR;
-    }
-    if (HAL_I2C_Master_Receive(hi2c, (uint16_t)device_addr, data, 1, 1000) != HAL_OK) {
-        if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_AF) {}
-        return HAL_ERROR;
+    /* Cyclic Jacobi rotations, eigenvalues end up on the diagonal of a and eigenvectors in the columns of v */
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            v[i][j] = i == j ? 1.0 : 0.0;
+
+    for (int sweep = 0; sweep < 16; sweep++) {
+        double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-24)
+            break;
+
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (a[p][q] == 0.0)
+                    continue;
+
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (int k = 0; k < 3; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
     }
-    return HAL_OK;
 }
 
-static HAL_StatusTypeDef readMultiBytes(I2C_HandleTypeDef *hi2c, uint8_t device_addr, uint8_t register_addr, uint8_t *data, uint16_t count)
+static void convertTemp(LIS3MDL_t *hsensor, const uint8_t *data)
 {
-    if (HAL_I2C_Master_Transmit(hi2c, (uint16_t)device_addr, &register_addr, 1, 1000) != HAL_OK) {
-        if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_AF) {}
-        return HAL_ERROR;
-    }
-    if (HAL_I2C_Master_Receive(hi2c, (uint16_t)device_addr, data, count, 1000) != HAL_OK) {
-        if (HAL_I2C_GetError(hi2c) != HAL_I2C_ERROR_AF) {}
-        return HAL_ERROR;
-    }
-    return HAL_OK;
+    hsensor->temp_raw = ((int16_t)data[1] << 8) | data[0];
+    hsensor->temp = hsensor->temp_raw * 0.125f;
 }
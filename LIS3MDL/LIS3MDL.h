@@ -14,6 +14,22 @@
 
 #include <stdint.h>
 #include "main.h"
+#include "Snapshot.h"
+
+/* I2C transport, the STM32 library is selected with LIS3MDL_HAL or LIS3MDL_LL */
+#ifdef LIS3MDL_HAL
+#define I2C_TypeDef         I2C_HandleTypeDef
+#define I2C_Mem_Write(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)     HAL_I2C_Mem_Write(ADR,DEV_ADR,REG_ADR,I2C_MEMADD_SIZE_8BIT,BUF,BUF_SIZE,TIMEOUT)
+#define I2C_Mem_Read(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)      HAL_I2C_Mem_Read(ADR,DEV_ADR,REG_ADR,I2C_MEMADD_SIZE_8BIT,BUF,BUF_SIZE,TIMEOUT)
+
+#elif LIS3MDL_LL
+#include "I2C_ll.h"
+#define I2C_TypeDef         I2C_TypeDef
+#define I2C_Mem_Write(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)     LL_I2C_Mem_Write(ADR,DEV_ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
+#define I2C_Mem_Read(ADR, DEV_ADR, REG_ADR, BUF, BUF_SIZE, TIMEOUT)      LL_I2C_Mem_Read(ADR,DEV_ADR,REG_ADR,BUF,BUF_SIZE,TIMEOUT)
+#endif /* LIS3MDL_LL */
+
+#define LIS3MDL_TIMEOUT     0xFF
 
 /* Structure and Enums */
 typedef enum {
@@ -58,50 +74,302 @@ typedef enum {
     LIS3MDL_ODR_FAST = 0x02
 } LIS3MDL_ODR_t;
 
+#define LIS3MDL_MGAUSS_Q    16      /* Fractional bits of LIS3MDL_t.mgauss_per_lsb */
+
 typedef struct {
-    float *mag_x;
-    float *mag_y;
-    float *mag_z;
+    float mag[3];               /* Field in gauss */
+    int32_t mag_mgauss[3];      /* Field in milligauss, filled by LIS3MDL_ReadMagInt */
     float temp;
     int16_t mag_raw[3];
     int16_t temp_raw;
     LIS3MDL_Scale_t scale;
     uint8_t addr;
+    /* Conversion factors, recomputed whenever the scale changes */
+    float gauss_per_lsb;
+    int32_t mgauss_per_lsb;     /* Q LIS3MDL_MGAUSS_Q, raw * mgauss_per_lsb fits int32_t at every scale */
 } LIS3MDL_t;
 
+/* Hard/soft-iron calibration */
+#define LIS3MDL_CALIB_MIN_SAMPLES   50  /* Fewer samples cannot cover the ellipsoid */
+
+/* Sufficient statistics of the ellipsoid fit, the memory does not grow with the number of samples */
+typedef struct {
+    double ata[9][9];           /* Upper triangle of D'D */
+    double atb[9];              /* D'1 */
+    uint32_t count;
+} LIS3MDL_CalibAccum_t;
+
+typedef struct {
+    float offset[3];            /* Hard-iron offset in gauss */
+    float matrix[3][3];         /* Soft-iron correction, maps the ellipsoid to a sphere of radius field */
+    float field;                /* Mean local field magnitude in gauss */
+    float hw_offset[3];         /* Part of the offset subtracted by the sensor OFFSET registers */
+    /* Fused conversion from raw counts, computed for the scale below */
+    float gain[3][3];
+    float bias[3];
+    LIS3MDL_Scale_t scale;
+} LIS3MDL_Calibration_t;
+
+/* Streaming acquisition driven by the DRDY pin, HAL only */
+#define LIS3MDL_STREAM_SIZE     32      /* Ring buffer length in samples, must be a power of two */
+
+typedef struct {
+    uint32_t time;              /* LIS3MDL_Timestamp() at the DRDY edge */
+    int16_t mag_raw[3];
+    int16_t temp_raw;
+    uint8_t status;             /* STATUS_REG read together with the sample */
+} LIS3MDL_Sample_t;
+
+typedef struct {
+    LIS3MDL_t *hsensor;
+    I2C_TypeDef *hi2c;
+    LIS3MDL_Sample_t ring[LIS3MDL_STREAM_SIZE];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint32_t dropped;  /* Samples lost because the ring was full */
+    volatile uint32_t overruns; /* Samples overwritten in the sensor before they were read (STATUS_REG ZYXOR) */
+    uint8_t buffer[9];
+    uint32_t edge_time;
+    uint32_t read_time;
+    volatile uint8_t busy;
+    volatile uint8_t pending;
+} LIS3MDL_Stream_t;
+
+/* Sensor state snapshot for warm start, see Snapshot.h */
+typedef struct {
+    Snapshot_header_t header;
+    uint8_t ctrl[5];            /* CTRL_REG1..CTRL_REG5 */
+    uint8_t int_cfg;
+    uint8_t scale;
+} LIS3MDL_Snapshot_t;
+
 /* Sensor Functions */
 /**
  * @brief         Initializes the sensor according to the specified parameters.
+ *                Takes four bus transactions: WHO_AM_I, one burst write of
+ *                CTRL_REG1..CTRL_REG5, one burst read to verify them and the
+ *                INT_CFG write.
  * 
  * @param hsensor Pointer to a LIS3MDL_t handler structure that contains the
  *                configuration and axis values information for specified sensor.
- * @param hi2c    Pointer to I2C_HandleTypeDef for the I2C bus.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
  * @param dev     Specified sensor device no for the I2C address selection.
  * @param scale   Magnetometer full scale selection.
  * @param mode    Sensor's operation mode selection.
  * @param odr     Sensor's output data rate selection.
  * @return        LIS3MDL status
  */
-LIS3MDL_Result_t LIS3MDL_Init(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c, LIS3MDL_Device_t dev, LIS3MDL_Scale_t scale, LIS3MDL_OperationMode_t mode, LIS3MDL_ODR_t odr);
+LIS3MDL_Result_t LIS3MDL_Init(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Device_t dev, LIS3MDL_Scale_t scale, LIS3MDL_OperationMode_t mode, LIS3MDL_ODR_t odr);
 
 /**
  * @brief         Reads the 3-axis magnetometer values for specified sensor.
  * 
  * @param hsensor Pointer to a LIS3MDL_t handler structure that contains the
  *                configuration and axis values information for specified sensor.
- * @param hi2c    Pointer to I2C_HandleTypeDef for the I2C bus.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
+ * @return        LIS3MDL status
+ */
+LIS3MDL_Result_t LIS3MDL_ReadMag(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c);
+
+/**
+ * @brief         Reads the 3-axis magnetometer values in integer milligauss,
+ *                without floating point arithmetic.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure that contains the
+ *                configuration and axis values information for specified sensor.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
  * @return        LIS3MDL status
  */
-LIS3MDL_Result_t LIS3MDL_ReadMag(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c);
+LIS3MDL_Result_t LIS3MDL_ReadMagInt(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c);
 
 /**
  * @brief         Reads the temperature in Celcius for specified sensor.
  * 
  * @param hsensor Pointer to a LIS3MDL_t handler structure that contains the
  *                configuration and axis values information for specified sensor.
- * @param hi2c    Pointer to I2C_HandleTypeDef for the I2C bus.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
  * @return        LIS3MDL status
  */
-LIS3MDL_Result_t LIS3MDL_ReadTemp(LIS3MDL_t *hsensor, I2C_HandleTypeDef *hi2c);
+LIS3MDL_Result_t LIS3MDL_ReadTemp(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c);
+
+/**
+ * @brief         Reads the magnetometer and temperature values in one burst.
+ *                OUT_X_L..TEMP_OUT_H are read with a single repeated-start
+ *                transaction, and BDU keeps the sample consistent.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure that contains the
+ *                configuration and axis values information for specified sensor.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
+ * @return        LIS3MDL status
+ */
+LIS3MDL_Result_t LIS3MDL_ReadMagTemp(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c);
+
+/**
+ * @brief         Saves the sensor configuration into a snapshot.
+ *                Reads back the control registers once, so call it after
+ *                LIS3MDL_Init and any further configuration.
+ * 
+ * @param hsensor Pointer to an initialized LIS3MDL_t handler structure.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
+ * @param snapshot Pointer to the snapshot to fill.
+ * @return        LIS3MDL status
+ */
+LIS3MDL_Result_t LIS3MDL_Save(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Snapshot_t *snapshot);
+
+/**
+ * @brief         Restores the sensor from a snapshot instead of LIS3MDL_Init.
+ *                Reads WHO_AM_I once at the stored address, validates the
+ *                snapshot CRC against it and rewrites the control registers
+ *                with one verified burst.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
+ * @param snapshot Pointer to the snapshot saved by LIS3MDL_Save.
+ * @return        LIS3MDL status, LIS3MDL_ERROR if the snapshot is corrupted
+ *                or belongs to another device
+ */
+LIS3MDL_Result_t LIS3MDL_Restore(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, const LIS3MDL_Snapshot_t *snapshot);
+
+/**
+ * @brief         Converts a block of buffered samples to gauss.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure, gives the scale.
+ * @param samples Samples, for example from LIS3MDL_ReadStream.
+ * @param mag     Array that receives the field in gauss.
+ * @param count   Number of samples.
+ */
+void LIS3MDL_ConvertSamples(const LIS3MDL_t *hsensor, const LIS3MDL_Sample_t *samples, float (*mag)[3], uint16_t count);
+
+/**
+ * @brief         Converts a block of buffered samples to integer milligauss.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure, gives the scale.
+ * @param samples Samples, for example from LIS3MDL_ReadStream.
+ * @param mag     Array that receives the field in milligauss.
+ * @param count   Number of samples.
+ */
+void LIS3MDL_ConvertSamplesInt(const LIS3MDL_t *hsensor, const LIS3MDL_Sample_t *samples, int32_t (*mag)[3], uint16_t count);
+
+/**
+ * @brief         Clears the calibration statistics before a new calibration.
+ * 
+ * @param acc     Pointer to the calibration statistics.
+ */
+void LIS3MDL_CalibReset(LIS3MDL_CalibAccum_t *acc);
+
+/**
+ * @brief         Adds one sample to the calibration statistics. Rotate the
+ *                vehicle through as many orientations as possible while
+ *                feeding samples; the cost is constant per sample.
+ *                Collect the samples with the OFFSET registers cleared.
+ * 
+ * @param acc     Pointer to the calibration statistics.
+ * @param mag     Field in gauss, for example from LIS3MDL_ReadMag.
+ */
+void LIS3MDL_CalibAdd(LIS3MDL_CalibAccum_t *acc, const float *mag);
+
+/**
+ * @brief         Fits an ellipsoid to the accumulated samples and computes
+ *                the hard-iron offset and the soft-iron matrix.
+ * 
+ * @param acc     Pointer to the calibration statistics.
+ * @param cal     Pointer to the calibration to fill.
+ * @return        LIS3MDL status, LIS3MDL_ERROR if there are too few samples or
+ *                they do not cover enough orientations to define an ellipsoid
+ */
+LIS3MDL_Result_t LIS3MDL_CalibSolve(const LIS3MDL_CalibAccum_t *acc, LIS3MDL_Calibration_t *cal);
+
+/**
+ * @brief         Converts raw counts to a calibrated field in one step:
+ *                out = gain * raw - bias, with the full-scale, the offset and
+ *                the soft-iron matrix folded into gain and bias.
+ * 
+ * @param hsensor Pointer to a LIS3MDL_t handler structure, gives the scale.
+ * @param cal     Pointer to the calibration from LIS3MDL_CalibSolve.
+ * @param raw     Raw magnetometer counts, for example hsensor->mag_raw.
+ * @param out     Calibrated field in gauss.
+ */
+void LIS3MDL_ApplyCalibration(const LIS3MDL_t *hsensor, LIS3MDL_Calibration_t *cal, const int16_t *raw, float *out);
+
+/**
+ * @brief         Writes the hard-iron offset into the OFFSET registers, so the
+ *                sensor outputs offset-free data and LIS3MDL_ApplyCalibration
+ *                only applies the soft-iron matrix. Rewrite it after a scale
+ *                change, because the registers are in output counts.
+ * 
+ * @param hsensor Pointer to an initialized LIS3MDL_t handler structure.
+ * @param hi2c    Pointer to the I2C bus (I2C_HandleTypeDef for HAL, I2C_TypeDef for LL).
+ * @param cal     Pointer to the calibration, or NULL to clear the registers.
+ * @return        LIS3MDL status
+ */
+LIS3MDL_Result_t LIS3MDL_WriteOffset(LIS3MDL_t *hsensor, I2C_TypeDef *hi2c, LIS3MDL_Calibration_t *cal);
+
+#ifdef LIS3MDL_HAL
+/**
+ * @brief         Returns the timestamp stored with each streamed sample.
+ *                Defaults to HAL_GetTick in ms; override it, for example with
+ *                a timer counter in us, for precise timestamps at fast ODR.
+ * 
+ * @return        Current time
+ */
+uint32_t LIS3MDL_Timestamp(void);
+
+/**
+ * @brief         Starts DRDY driven acquisition into the stream ring buffer.
+ *                The DRDY pin is always driven by the sensor and stays high
+ *                until the sample is read, so configure it in CubeMX as EXTI
+ *                on the rising edge. For the 1 kHz rate initialize the sensor
+ *                with LIS3MDL_MODE_LOWPOWER and LIS3MDL_ODR_FAST.
+ *                The first read is started immediately to release DRDY if it
+ *                is already high.
+ * 
+ * @param stream  Pointer to the stream state.
+ * @param hsensor Pointer to an initialized LIS3MDL_t handler structure.
+ * @param hi2c    Pointer to I2C_HandleTypeDef for the I2C bus.
+ * @return        LIS3MDL status, LIS3MDL_ERROR if the bus was busy; the read
+ *                is then retried by LIS3MDL_ReadStream
+ */
+LIS3MDL_Result_t LIS3MDL_StartStream(LIS3MDL_Stream_t *stream, LIS3MDL_t *hsensor, I2C_TypeDef *hi2c);
+
+/**
+ * @brief         DRDY pin handler, call it from HAL_GPIO_EXTI_Callback.
+ *                Stores the edge time and starts a non-blocking burst read of
+ *                STATUS_REG..TEMP_OUT_H.
+ * 
+ * @param stream  Pointer to the stream state.
+ */
+void LIS3MDL_DRDY_Callback(LIS3MDL_Stream_t *stream);
+
+/**
+ * @brief         Read completion handler, call it from HAL_I2C_MemRxCpltCallback
+ *                for the stream's I2C bus. Pushes the sample into the ring.
+ *                Completions of other drivers' transfers push nothing, they
+ *                only start a read deferred while the bus was taken.
+ * 
+ * @param stream  Pointer to the stream state.
+ */
+void LIS3MDL_I2C_Callback(LIS3MDL_Stream_t *stream);
+
+/**
+ * @brief         Read error handler, call it from HAL_I2C_ErrorCallback for the
+ *                stream's I2C bus. The read is retried by LIS3MDL_ReadStream.
+ *                Errors of other drivers' transfers are ignored.
+ * 
+ * @param stream  Pointer to the stream state.
+ */
+void LIS3MDL_I2C_ErrorCallback(LIS3MDL_Stream_t *stream);
+
+/**
+ * @brief         Takes the accumulated samples out of the ring buffer.
+ *                Safe to call from the main loop while streaming. Also retries
+ *                a read postponed by a busy bus or an error.
+ * 
+ * @param stream  Pointer to the stream state.
+ * @param samples Array that receives the samples in arrival order.
+ * @param max     Size of the array in samples.
+ * @return        Number of samples copied
+ */
+uint16_t LIS3MDL_ReadStream(LIS3MDL_Stream_t *stream, LIS3MDL_Sample_t *samples, uint16_t max);
+#endif /* LIS3MDL_HAL */
 
 #endif /* LIS3MDL_H */
@@ -0,0 +1,63 @@
+/**
+ * @file LIS3MDL_Registers.h
+ * @author Talha Sarı (talha.sari@outlook.com.tr)
+ * @brief LIS3MDL register map
+ * @version v1.1
+ * @date 2021-06-07
+ * 
+ * @copyright Copyright (c) 2021 - GNU General Public License v3
+ * 
+ */
+
+#ifndef LIS3MDL_REGISTERS_H
+#define LIS3MDL_REGISTERS_H
+
+/* Register Addresses */
+#define OFFSET_X_REG_L_M    0x05
+#define OFFSET_X_REG_H_M    0x06
+#define OFFSET_Y_REG_L_M    0x07
+#define OFFSET_Y_REG_H_M    0x08
+#define OFFSET_Z_REG_L_M    0x09
+#define OFFSET_Z_REG_H_M    0x0A
+
+#define WHO_AM_I            0x0F
+
+#define CTRL_REG1           0x20
+#define CTRL_REG2           0x21
+#define CTRL_REG3           0x22
+#define CTRL_REG4           0x23
+#define CTRL_REG5           0x24
+
+#define STATUS_REG          0x27
+#define OUT_X_L             0x28
+#define OUT_X_H             0x29
+#define OUT_Y_L             0x2A
+#define OUT_Y_H             0x2B
+#define OUT_Z_L             0x2C
+#define OUT_Z_H             0x2D
+#define TEMP_OUT_L          0x2E
+#define TEMP_OUT_H          0x2F
+
+#define INT_CFG             0x30
+#define INT_SRC             0x31
+#define INT_THS_L           0x32
+#define INT_THS_H           0x33
+
+/* Register Values */
+#define WHO_AM_I_VALUE      0x3D
+
+/* Setting the MSB of the register address enables address auto-increment for multi-byte transfers */
+#define AUTO_INCREMENT      0x80
+
+/* CTRL_REG1 */
+#define CTRL_REG1_TEMP_EN   0x80
+
+/* STATUS_REG */
+#define STATUS_ZYXOR        0x80
+#define STATUS_ZYXDA        0x08
+
+/* CTRL_REG5 */
+#define CTRL_REG5_FAST_READ 0x80
+#define CTRL_REG5_BDU       0x40
+
+#endif /* LIS3MDL_REGISTERS_H */
@@ -1,66 +1,90 @@
+#include <math.h>
 #include <stdint.h>
+#include <string.h>
 #include "LSM6DS33.h"
-
-LSM6DS33_cfg LSM6DS33_config;
-I2C_HandleTypeDef* LSM6DS33_hi2c;
+#ifdef LSM6DS33_ARM_MATH
+#include "arm_math.h"
+#endif /* LSM6DS33_ARM_MATH */
 
 float FULL_SCALES_A[4] = {0.061f, 0.488f, 0.122f, 0.244f};
 float FULL_SCALES_G[4] = {8.75f, 17.5f, 35.0f, 70.0f};
 
-float a_ref[3] = {0};
-float g_ref[3] = {0};
-
-float full_scale_A;
-float full_scale_G;
-
-uint32_t LSM6DS33_ADDRESS;
+#ifdef LSM6DS33_HAL
+LSM6DS33_t *LSM6DS33_IT_devices[LSM6DS33_IT_MAX_DEVICES];
+#endif /* LSM6DS33_HAL */
 
 void __LSM6DS33_modify_reg(uint8_t *reg_data, uint8_t mask, uint8_t bits) {
 	*reg_data &= ~mask;
 	*reg_data |= bits;
 }
 
-HAL_StatusTypeDef LSM6DS33_init(I2C_HandleTypeDef* hi2c_) {
+int32_t __LSM6DS33_to_q(float value, uint8_t q) {
+	value *= (float)(1 << q);
+	return (int32_t)(value < 0 ? value - 0.5f : value + 0.5f);
+}
+
+void __LSM6DS33_update_scale(LSM6DS33_t *dev) {
+	//!< Все множители преобразования собираются в одну цену младшего разряда при смене full-scale
+	dev->scale_A = dev->full_scale_A * 0.001f * 9.80665f;
+	dev->scale_G = dev->full_scale_G * 0.001f;
+	dev->scale_A_q = __LSM6DS33_to_q(dev->full_scale_A * 9.80665f, LSM6DS33_SCALE_A_Q);
+	dev->scale_G_q = __LSM6DS33_to_q(dev->full_scale_G, LSM6DS33_SCALE_G_Q);
+
+	for(int i = 0; i < 3; i++) {
+		dev->a_ref_q[i] = __LSM6DS33_to_q(dev->a_ref[i] * 1000.0f, LSM6DS33_SCALE_A_Q);
+		dev->g_ref_q[i] = __LSM6DS33_to_q(dev->g_ref[i] * 1000.0f, LSM6DS33_SCALE_G_Q);
+	}
+}
+
+HAL_StatusTypeDef LSM6DS33_init(LSM6DS33_t *dev, I2C_TypeDef *hi2c_, uint16_t address) {
 	HAL_StatusTypeDef status;
-	uint8_t id;
-	if((status = I2C_Mem_Read(hi2c_, 0xD7, LSM6DS33_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
-		LSM6DS33_ADDRESS = 0xD7;
+	uint8_t id = 0;
+	memset(dev, 0, sizeof(LSM6DS33_t));
+
+	if(address != LSM6DS33_ADDRESS_AUTO) {
+		status = I2C_Mem_Read(hi2c_, address, LSM6DS33_REGISTER_ID, &id, 1, 0xFF);
+	}
+	else if((status = I2C_Mem_Read(hi2c_, LSM6DS33_ADDRESS_1, LSM6DS33_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
+		address = LSM6DS33_ADDRESS_1;
 	}
-	else if((status = I2C_Mem_Read(hi2c_, 0xD5, LSM6DS33_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
-		LSM6DS33_ADDRESS = 0xD5;
+	else if((status = I2C_Mem_Read(hi2c_, LSM6DS33_ADDRESS_0, LSM6DS33_REGISTER_ID, &id, 1, 0xFF)) == HAL_OK) {
+		address = LSM6DS33_ADDRESS_0;
 	}
+	dev->address = address;
 
-	full_scale_A = FULL_SCALES_A[0];
-	full_scale_G = FULL_SCALES_G[0];
+	dev->full_scale_A = FULL_SCALES_A[0];
+	dev->full_scale_G = FULL_SCALES_G[0];
+	__LSM6DS33_update_scale(dev);
 
 	if(id == 0x69) {
-		LSM6DS33_hi2c = hi2c_;
-		LSM6DS33_config.ORIENT_config = 0b0;
-		LSM6DS33_config.CTRL1_config;
-		LSM6DS33_config.CTRL2_config = 0b0;
-		LSM6DS33_config.CTRL3_config = 0b01000100;
-		LSM6DS33_config.CTRL7_config = 0b11101000;
-		LSM6DS33_config.CTRL8_config = 0b11000000;
-		LSM6DS33_config.CTRL10_config = 0b00010000;
+		dev->hi2c = hi2c_;
+		dev->config.ORIENT_config = 0b0;
+		dev->config.CTRL1_config;
+		dev->config.CTRL2_config = 0b0;
+		dev->config.CTRL3_config = 0b01000100;
+		dev->config.CTRL7_config = 0b11101000;
+		dev->config.CTRL8_config = 0b11000000;
+		dev->config.TAP_config = 0b00010000;
+		dev->config.CTRL10_config = 0b00111000;
 
 		//!< Включаем фильтр для акселерометра
-		if((status = I2C_Mem_Write(hi2c_, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL8, &LSM6DS33_config.CTRL8_config, 1, 0xFF)) != HAL_OK) {
+		if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL8, &dev->config.CTRL8_config, 1, 0xFF)) != HAL_OK) {
 			return status;
 		}
 
 		//!< Включаем фильтр
-		if((status = I2C_Mem_Write(hi2c_, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_TAP_CFG, &LSM6DS33_config.CTRL10_config, 1, 0xFF)) != HAL_OK) {
+		if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_TAP_CFG, &dev->config.TAP_config, 1, 0xFF)) != HAL_OK) {
 			return status;
 		}
 
 		//!< Включаем HPF для гироскопа
-		if((status = I2C_Mem_Write(hi2c_, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL7, &LSM6DS33_config.CTRL7_config, 1, 0xFF)) != HAL_OK) {
+		if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL7, &dev->config.CTRL7_config, 1, 0xFF)) != HAL_OK) {
 			return status;
 		}
 
 		//!< Устанавливаем частоту гироскопа и акселерометра 52Гц
-		LSM6DS33_config_perfomance_mode(LSM6DS33_ODR_52HZ, LSM6DS33_ODR_52HZ);
-		if((status = I2C_Mem_Write(hi2c_, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL3, &LSM6DS33_config.CTRL3_config, 1, 0xFF)) != HAL_OK) {
+		LSM6DS33_config_perfomance_mode(dev, LSM6DS33_ODR_52HZ, LSM6DS33_ODR_52HZ);
+		if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL3, &dev->config.CTRL3_config, 1, 0xFF)) != HAL_OK) {
 			return status;
 		}
 		return HAL_OK;
@@ -68,108 +92,109 @@ HAL_StatusTypeDef LSM6DS33_init(I2C_HandleTypeDef* hi2c_) {
 	return HAL_ERROR;
 }
 
-HAL_StatusTypeDef LSM6DS33_config_orientation(uint8_t orient, uint8_t signs) {
+HAL_StatusTypeDef LSM6DS33_config_orientation(LSM6DS33_t *dev, uint8_t orient, uint8_t signs) {
 	HAL_StatusTypeDef status;
 	if(signs > 0b111) return HAL_ERROR;
-	__LSM6DS33_modify_reg(&LSM6DS33_config.ORIENT_config, LSM6DS33_ORIENT_CFG_MASK, (signs<<3) + orient);
-	if((status = I2C_Mem_Write(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_ORIENT_CFG, &LSM6DS33_config.ORIENT_config, 1, 0xFF)) != HAL_OK) {
+	__LSM6DS33_modify_reg(&dev->config.ORIENT_config, LSM6DS33_ORIENT_CFG_MASK, (signs<<3) + orient);
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_ORIENT_CFG, &dev->config.ORIENT_config, 1, 0xFF)) != HAL_OK) {
 		return status;
 	}
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_config_filters(uint8_t g_HPF, uint8_t g_HPF_frequency, uint8_t a_HPF) {
+HAL_StatusTypeDef LSM6DS33_config_filters(LSM6DS33_t *dev, uint8_t g_HPF, uint8_t g_HPF_frequency, uint8_t a_HPF) {
 	HAL_StatusTypeDef status;
 
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL7_config, LSM6DS33_GYRO_HPF_MASK, (g_HPF << 6) + (g_HPF_frequency << 4));
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL8_config, LSM6DS33_A_FILTER_MASK, a_HPF << 5);
+	__LSM6DS33_modify_reg(&dev->config.CTRL7_config, LSM6DS33_GYRO_HPF_MASK, (g_HPF << 6) + (g_HPF_frequency << 4));
+	__LSM6DS33_modify_reg(&dev->config.CTRL8_config, LSM6DS33_A_FILTER_MASK, a_HPF << 5);
 
-	if((status = I2C_Mem_Write(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL7, &LSM6DS33_config.CTRL7_config, 2, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL7, &dev->config.CTRL7_config, 2, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_config_full_scale(uint8_t a_FS, uint8_t g_FS) {
+HAL_StatusTypeDef LSM6DS33_config_full_scale(LSM6DS33_t *dev, uint8_t a_FS, uint8_t g_FS) {
 	HAL_StatusTypeDef status;
 
 	if(a_FS > 0b11 || a_FS < 0 || g_FS > 0b11 || g_FS < 0) return HAL_ERROR;
 
-	full_scale_A = FULL_SCALES_A[a_FS];
-	full_scale_G = FULL_SCALES_G[g_FS];
+	dev->full_scale_A = FULL_SCALES_A[a_FS];
+	dev->full_scale_G = FULL_SCALES_G[g_FS];
+	__LSM6DS33_update_scale(dev);
 
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL1_config, LSM6DS33_FULL_SCALE_MASK, a_FS << 2);
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL2_config, LSM6DS33_FULL_SCALE_MASK, g_FS << 2);
-	if((status = I2C_Mem_Write(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL1, &LSM6DS33_config.CTRL1_config, 2, 0xFF)) != HAL_OK) {
+	__LSM6DS33_modify_reg(&dev->config.CTRL1_config, LSM6DS33_FULL_SCALE_MASK, a_FS << 2);
+	__LSM6DS33_modify_reg(&dev->config.CTRL2_config, LSM6DS33_FULL_SCALE_MASK, g_FS << 2);
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL1, &dev->config.CTRL1_config, 2, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_config_perfomance_mode(uint8_t a_ODR, uint8_t g_ODR) {
+HAL_StatusTypeDef LSM6DS33_config_perfomance_mode(LSM6DS33_t *dev, uint8_t a_ODR, uint8_t g_ODR) {
 	HAL_StatusTypeDef status;
 
 	if(a_ODR > 0b1010 || a_ODR < 0b0 || g_ODR > 0b1000 || g_ODR < 0b0) return HAL_ERROR;
 
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL1_config, LSM6DS33_ODR_MASK, a_ODR << 4);
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL2_config, LSM6DS33_ODR_MASK, g_ODR << 4);
+	__LSM6DS33_modify_reg(&dev->config.CTRL1_config, LSM6DS33_ODR_MASK, a_ODR << 4);
+	__LSM6DS33_modify_reg(&dev->config.CTRL2_config, LSM6DS33_ODR_MASK, g_ODR << 4);
 
-	if((status = I2C_Mem_Write(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL1, &LSM6DS33_config.CTRL1_config, 2, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL1, &dev->config.CTRL1_config, 2, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_reset() {
+HAL_StatusTypeDef LSM6DS33_reset(LSM6DS33_t *dev) {
 	HAL_StatusTypeDef status;
 
-	__LSM6DS33_modify_reg(&LSM6DS33_config.CTRL3_config, 0b00000001, 0b0);
+	__LSM6DS33_modify_reg(&dev->config.CTRL3_config, 0b00000001, 0b0);
 
-	if((status = I2C_Mem_Write(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_CTRL3, &LSM6DS33_config.CTRL3_config, 1, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL3, &dev->config.CTRL3_config, 1, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_A_get_measure(float *a) {
+HAL_StatusTypeDef LSM6DS33_A_get_measure(LSM6DS33_t *dev, float *a) {
 	HAL_StatusTypeDef status;
 
 	int16_t raw_data[3];
-	if((status = I2C_Mem_Read(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_OUT_A, (uint8_t*)&raw_data, 6, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_A, (uint8_t*)&raw_data, 6, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	for(int i = 0; i < 3; i++) {
-		a[i] = (raw_data[i] * full_scale_A * 0.001f * 9.80665f) - a_ref[i];
+		a[i] = raw_data[i] * dev->scale_A - dev->a_ref[i];
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_G_get_measure(float *g) {
+HAL_StatusTypeDef LSM6DS33_G_get_measure(LSM6DS33_t *dev, float *g) {
 	HAL_StatusTypeDef status;
 
 	int16_t raw_data[3];
-	if((status = I2C_Mem_Read(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_OUT_G, (uint8_t*)&raw_data, 6, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_G, (uint8_t*)&raw_data, 6, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	for(int i = 0; i < 3; i++) {
-		g[i] = (raw_data[i] * full_scale_G * 0.001f);
+		g[i] = raw_data[i] * dev->scale_G - dev->g_ref[i];
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_T_get_measure(float *t) {
+HAL_StatusTypeDef LSM6DS33_T_get_measure(LSM6DS33_t *dev, float *t) {
 	HAL_StatusTypeDef status;
 
 	uint16_t raw_data;
-	if((status = I2C_Mem_Read(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_OUT_T, (uint8_t*)&raw_data, 2, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_T, (uint8_t*)&raw_data, 2, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
@@ -178,35 +203,879 @@ HAL_StatusTypeDef LSM6DS33_T_get_measure(float *t) {
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_get_measure(float* a, float *g) {
+HAL_StatusTypeDef LSM6DS33_get_measure(LSM6DS33_t *dev, float* a, float *g) {
 	HAL_StatusTypeDef status;
 
 	int16_t raw_data[6];
-	if((status = I2C_Mem_Read(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_OUT_G, (uint8_t*)&raw_data, 12, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_G, (uint8_t*)&raw_data, 12, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	for(int i = 0; i < 3; i++) {
-	  g[i] = (raw_data[i] * full_scale_G * 0.001f);
-	  a[i] = (raw_data[i+3] * full_scale_A * 0.001f * 9.80665f);
+		g[i] = raw_data[i] * dev->scale_G - dev->g_ref[i];
+		a[i] = raw_data[i+3] * dev->scale_A - dev->a_ref[i];
 	}
 
 	return HAL_OK;
 }
 
-HAL_StatusTypeDef LSM6DS33_get_all_measure(float *a, float *g, float *t) {
+HAL_StatusTypeDef LSM6DS33_get_all_measure(LSM6DS33_t *dev, float *a, float *g, float *t) {
 	HAL_StatusTypeDef status;
 
 	int16_t raw_data[7];
-	if((status = I2C_Mem_Read(LSM6DS33_hi2c, LSM6DS33_ADDRESS, LSM6DS33_REGISTER_OUT_T, (uint8_t*)&raw_data, 14, 0xFF)) != HAL_OK) {
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_T, (uint8_t*)&raw_data, 14, 0xFF)) != HAL_OK) {
 		return status;
 	}
 
 	for(int i = 0; i < 3; i++) {
-		g[i] = (raw_data[i+1] * full_scale_G * 0.001f) - g_ref[i];
-		a[i] = (raw_data[i+4] * full_scale_A * 0.001f * 9.80665f) - a_ref[i];
+		g[i] = raw_data[i+1] * dev->scale_G - dev->g_ref[i];
+		a[i] = raw_data[i+4] * dev->scale_A - dev->a_ref[i];
 	}
 	*t = ((float) raw_data[0])*125/(float)0x8000 + 26;
 
 	return HAL_OK;
 }
+
+HAL_StatusTypeDef LSM6DS33_config_FIFO(LSM6DS33_t *dev, uint8_t mode, uint8_t ODR, uint8_t a_dec, uint8_t g_dec, uint16_t watermark) {
+	HAL_StatusTypeDef status;
+
+	if(mode > 0b110 || ODR > 0b1010 || a_dec > 0b111 || g_dec > 0b111) return HAL_ERROR;
+
+	//!< Разбор FIFO рассчитан на то, что каждый набор содержит все записываемые датчики
+	if(a_dec && g_dec && a_dec != g_dec) return HAL_ERROR;
+
+	//!< При включенном счетчике времени третьим набором записывается метка времени с прореживанием самого частого датчика
+	uint8_t t_dec = 0;
+	if(dev->config.TAP_config & LSM6DS33_TAP_CFG_TIMER_EN) {
+		t_dec = (a_dec && (!g_dec || a_dec < g_dec)) ? a_dec : g_dec;
+	}
+
+	//!< Порог задается в словах: по 3 слова на каждый записываемый набор
+	uint32_t words = (uint32_t)watermark * 3 * ((a_dec != 0) + (g_dec != 0) + (t_dec != 0));
+	if(words >= LSM6DS33_FIFO_SIZE) words = LSM6DS33_FIFO_SIZE - 1;
+
+	dev->config.FIFO_config[0] = words & 0xFF;
+	dev->config.FIFO_config[1] = ((words >> 8) & 0x0F) | (t_dec ? LSM6DS33_FIFO_CTRL2_TIMER_EN : 0);
+	dev->config.FIFO_config[2] = (g_dec << 3) | a_dec;
+	dev->config.FIFO_config[3] = t_dec << 3;
+	dev->config.FIFO_config[4] = (ODR << 3) | mode;
+
+	//!< Перевод в режим bypass очищает FIFO, чтобы в нем не остались данные со старым порядком слов
+	uint8_t bypass = LSM6DS33_FIFO_MODE_BYPASS;
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_CTRL5, &bypass, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_CTRL1, dev->config.FIFO_config, 5, 0xFF);
+}
+
+HAL_StatusTypeDef __LSM6DS33_FIFO_read_status(LSM6DS33_t *dev, uint16_t *words, uint8_t *flags, uint16_t *pattern) {
+	HAL_StatusTypeDef status;
+
+	//!< FIFO_STATUS1..FIFO_STATUS4: количество слов, флаги и номер следующего слова в наборе
+	uint8_t data[4];
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_STATUS1, data, 4, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	*words = data[0] | ((uint16_t)(data[1] & 0x0F) << 8);
+	*flags = data[1] & 0xF0;
+	*pattern = data[2] | ((uint16_t)(data[3] & 0x03) << 8);
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_FIFO_status(LSM6DS33_t *dev, uint16_t *words, uint8_t *flags) {
+	uint16_t pattern;
+
+	return __LSM6DS33_FIFO_read_status(dev, words, flags, &pattern);
+}
+
+HAL_StatusTypeDef __LSM6DS33_FIFO_read_words(LSM6DS33_t *dev, uint16_t words) {
+#ifdef LSM6DS33_LL
+	//!< Длина в LL_I2C_Mem_Read 8-битная, поэтому длинный блок читается пакетами не больше 254 байт.
+	//!< Каждый пакет заканчивается на границе слова, так что следующий снова начинается с FIFO_DATA_OUT_L
+	HAL_StatusTypeDef status;
+
+	for(uint16_t done = 0; done < words;) {
+		uint16_t burst = words - done;
+		if(burst > 127) burst = 127;
+		if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_DATA_OUT, (uint8_t*)&dev->FIFO_buffer[done], burst * 2, 0xFF)) != HAL_OK) {
+			return status;
+		}
+		done += burst;
+	}
+
+	return HAL_OK;
+#else
+	return I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_DATA_OUT, (uint8_t*)dev->FIFO_buffer, words * 2, 0xFF);
+#endif
+}
+
+HAL_StatusTypeDef __LSM6DS33_FIFO_begin(LSM6DS33_t *dev, uint16_t max_samples, uint16_t *count, uint8_t *set) {
+	HAL_StatusTypeDef status;
+
+	*count = 0;
+	*set = 3 * (((dev->config.FIFO_config[2] & 0b111) != 0) + ((dev->config.FIFO_config[2] >> 3) != 0) + ((dev->config.FIFO_config[3] >> 3) != 0));
+	if(*set == 0) return HAL_ERROR;
+
+	uint16_t words, pattern;
+	uint8_t flags;
+	if((status = __LSM6DS33_FIFO_read_status(dev, &words, &flags, &pattern)) != HAL_OK) {
+		return status;
+	}
+
+	//!< Чтение FIFO не с начала набора (после переполнения или ручного чтения) - отбрасываем слова до следующего набора
+	if(pattern % *set) {
+		uint16_t skip = *set - pattern % *set;
+		if(skip > words) skip = words;
+		if((status = __LSM6DS33_FIFO_read_words(dev, skip)) != HAL_OK) {
+			return status;
+		}
+		words -= skip;
+	}
+
+	*count = words / *set;
+	if(*count > max_samples) *count = max_samples;
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef __LSM6DS33_FIFO_read_chunk(LSM6DS33_t *dev, uint16_t chunk, uint8_t set, int16_t (*a)[3], int16_t (*g)[3], uint32_t *time) {
+	HAL_StatusTypeDef status;
+
+	uint8_t a_on = (dev->config.FIFO_config[2] & 0b111) != 0;
+	uint8_t g_on = (dev->config.FIFO_config[2] >> 3) != 0;
+
+	//!< При чтении нескольких байт адрес FIFO_DATA_OUT_H возвращается к FIFO_DATA_OUT_L, весь блок читается одной транзакцией
+	//!< (в сборке с LSM6DS33_LL - несколькими, см. __LSM6DS33_FIFO_read_words)
+	if((status = __LSM6DS33_FIFO_read_words(dev, chunk * set)) != HAL_OK) {
+		return status;
+	}
+
+	//!< В наборе сначала идут слова гироскопа, затем акселерометра, затем метки времени
+	for(uint16_t k = 0; k < chunk; k++) {
+		int16_t *word = &dev->FIFO_buffer[k * set];
+		if(g_on) {
+			for(int i = 0; i < 3; i++) {
+				g[k][i] = word[i];
+			}
+			word += 3;
+		}
+		if(a_on) {
+			for(int i = 0; i < 3; i++) {
+				a[k][i] = word[i];
+			}
+			word += 3;
+		}
+		if(time) {
+			//!< Байты метки времени в FIFO: TIMESTAMP1, TIMESTAMP2, не используется, TIMESTAMP0, счетчик шагов
+			time[k] = ((uint32_t)(uint16_t)word[0] << 8) | ((uint16_t)word[1] >> 8);
+		}
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_FIFO_drain_raw(LSM6DS33_t *dev, int16_t (*a)[3], int16_t (*g)[3], uint16_t max_samples, uint16_t *samples) {
+	HAL_StatusTypeDef status;
+
+	uint16_t count;
+	uint8_t set;
+	*samples = 0;
+	if((status = __LSM6DS33_FIFO_begin(dev, max_samples, &count, &set)) != HAL_OK) {
+		return status;
+	}
+
+	while(count) {
+		uint16_t chunk = count > LSM6DS33_FIFO_CHUNK ? LSM6DS33_FIFO_CHUNK : count;
+
+		if((status = __LSM6DS33_FIFO_read_chunk(dev, chunk, set, a + *samples, g + *samples, NULL)) != HAL_OK) {
+			return status;
+		}
+
+		*samples += chunk;
+		count -= chunk;
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_FIFO_drain(LSM6DS33_t *dev, float (*a)[3], float (*g)[3], uint16_t max_samples, uint16_t *samples) {
+	HAL_StatusTypeDef status;
+
+	int16_t a_raw[LSM6DS33_FIFO_CHUNK][3];
+	int16_t g_raw[LSM6DS33_FIFO_CHUNK][3];
+
+	uint16_t count;
+	uint8_t set;
+	*samples = 0;
+	if((status = __LSM6DS33_FIFO_begin(dev, max_samples, &count, &set)) != HAL_OK) {
+		return status;
+	}
+
+	uint8_t a_on = (dev->config.FIFO_config[2] & 0b111) != 0;
+	uint8_t g_on = (dev->config.FIFO_config[2] >> 3) != 0;
+
+	while(count) {
+		uint16_t chunk = count > LSM6DS33_FIFO_CHUNK ? LSM6DS33_FIFO_CHUNK : count;
+
+		if((status = __LSM6DS33_FIFO_read_chunk(dev, chunk, set, a_raw, g_raw, NULL)) != HAL_OK) {
+			return status;
+		}
+
+		if(a_on) LSM6DS33_A_convert(dev, a_raw, a + *samples, chunk);
+		if(g_on) LSM6DS33_G_convert(dev, g_raw, g + *samples, chunk);
+
+		*samples += chunk;
+		count -= chunk;
+	}
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_config_timestamp(LSM6DS33_t *dev, uint8_t enable) {
+	HAL_StatusTypeDef status;
+
+	//!< Разрешение 25 мкс: счетчик переполняется через 419 с
+	__LSM6DS33_modify_reg(&dev->config.MD_config[LSM6DS33_MD_WAKE_UP_DUR], LSM6DS33_WAKE_UP_DUR_TIMER_HR, enable ? LSM6DS33_WAKE_UP_DUR_TIMER_HR : 0);
+	__LSM6DS33_modify_reg(&dev->config.TAP_config, LSM6DS33_TAP_CFG_TIMER_EN, enable ? LSM6DS33_TAP_CFG_TIMER_EN : 0);
+	memset(&dev->clock, 0, sizeof(LSM6DS33_clock_t));
+
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_WAKE_UP_DUR, &dev->config.MD_config[LSM6DS33_MD_WAKE_UP_DUR], 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_TAP_CFG, &dev->config.TAP_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	uint8_t reset = LSM6DS33_TIMESTAMP_RESET;
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_TIMESTAMP2, &reset, 1, 0xFF);
+}
+
+uint64_t __LSM6DS33_clock_map(const LSM6DS33_clock_t *clock, uint64_t ticks) {
+	int64_t d = (int64_t)(ticks - clock->base_ticks);
+	return clock->base_us + ((d * (int64_t)clock->rate_q16) >> 16);
+}
+
+void __LSM6DS33_clock_update(LSM6DS33_clock_t *clock, uint32_t raw, uint64_t time_us) {
+	raw &= LSM6DS33_TIMESTAMP_MASK;
+
+	if(!clock->synced) {
+		clock->ticks = raw;
+		clock->raw = raw;
+		clock->anchor_ticks = clock->base_ticks = raw;
+		clock->anchor_us = clock->base_us = time_us;
+		clock->rate_q16 = LSM6DS33_TIMESTAMP_LSB_US << 16;
+		clock->synced = 1;
+		return;
+	}
+
+	clock->ticks += (raw - clock->raw) & LSM6DS33_TIMESTAMP_MASK;
+	clock->raw = raw;
+
+	//!< Частота генератора датчика оценивается по всему интервалу с первой синхронизации, поэтому задержки отдельных
+	//!< обменов усредняются
+	uint64_t span = clock->ticks - clock->anchor_ticks;
+	if(span >= LSM6DS33_CLOCK_SPAN) {
+		clock->rate_q16 = (uint32_t)(((time_us - clock->anchor_us) << 16) / span);
+	}
+
+	//!< Время МК берется после обмена и запаздывает на случайную величину: ранние отсчеты принимаются быстрее поздних
+	uint64_t predicted = __LSM6DS33_clock_map(clock, clock->ticks);
+	int64_t error = (int64_t)(time_us - predicted);
+	clock->base_ticks = clock->ticks;
+	clock->base_us = predicted + (error < 0 ? error / 2 : error / LSM6DS33_CLOCK_GAIN);
+}
+
+uint64_t LSM6DS33_time_convert(LSM6DS33_t *dev, uint32_t timestamp) {
+	//!< Разность с последней синхронизацией берется как 24-битное число со знаком, поэтому метка может быть
+	//!< старше или новее синхронизации не более чем на половину периода счетчика (209 с)
+	int32_t d = (int32_t)((timestamp - dev->clock.raw) << 8) >> 8;
+	uint64_t ticks = dev->clock.ticks + d;
+
+	return __LSM6DS33_clock_map(&dev->clock, ticks);
+}
+
+HAL_StatusTypeDef LSM6DS33_time_sync(LSM6DS33_t *dev, uint64_t *time) {
+	HAL_StatusTypeDef status;
+
+	uint8_t data[3];
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_TIMESTAMP0, data, 3, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	__LSM6DS33_clock_update(&dev->clock, data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16), LSM6DS33_time_us());
+	if(time) *time = dev->clock.base_us;
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_FIFO_drain_timed(LSM6DS33_t *dev, float (*a)[3], float (*g)[3], uint64_t *time, uint16_t max_samples, uint16_t *samples) {
+	HAL_StatusTypeDef status;
+
+	int16_t a_raw[LSM6DS33_FIFO_CHUNK][3];
+	int16_t g_raw[LSM6DS33_FIFO_CHUNK][3];
+	uint32_t t_raw[LSM6DS33_FIFO_CHUNK];
+
+	*samples = 0;
+	if(!(dev->config.FIFO_config[3] >> 3)) return HAL_ERROR;
+
+	//!< Синхронизация непосредственно перед чтением FIFO, чтобы метки были близки к точке синхронизации
+	if((status = LSM6DS33_time_sync(dev, NULL)) != HAL_OK) {
+		return status;
+	}
+
+	uint16_t count;
+	uint8_t set;
+	if((status = __LSM6DS33_FIFO_begin(dev, max_samples, &count, &set)) != HAL_OK) {
+		return status;
+	}
+
+	uint8_t a_on = (dev->config.FIFO_config[2] & 0b111) != 0;
+	uint8_t g_on = (dev->config.FIFO_config[2] >> 3) != 0;
+
+	while(count) {
+		uint16_t chunk = count > LSM6DS33_FIFO_CHUNK ? LSM6DS33_FIFO_CHUNK : count;
+
+		if((status = __LSM6DS33_FIFO_read_chunk(dev, chunk, set, a_raw, g_raw, t_raw)) != HAL_OK) {
+			return status;
+		}
+
+		if(a_on) LSM6DS33_A_convert(dev, a_raw, a + *samples, chunk);
+		if(g_on) LSM6DS33_G_convert(dev, g_raw, g + *samples, chunk);
+		for(uint16_t k = 0; k < chunk; k++) {
+			time[*samples + k] = LSM6DS33_time_convert(dev, t_raw[k]);
+		}
+
+		*samples += chunk;
+		count -= chunk;
+	}
+
+	return HAL_OK;
+}
+
+void LSM6DS33_set_reference(LSM6DS33_t *dev, const float *a, const float *g) {
+	for(int i = 0; i < 3; i++) {
+		dev->a_ref[i] = a[i];
+		dev->g_ref[i] = g[i];
+	}
+
+	__LSM6DS33_update_scale(dev);
+}
+
+void __LSM6DS33_welford(float *mean, float *m2, uint32_t n, const int16_t *x) {
+	//!< Среднее и сумма квадратов отклонений обновляются по одному измерению без потери точности на больших n
+	for(int i = 0; i < 3; i++) {
+		float delta = x[i] - mean[i];
+		mean[i] += delta / n;
+		m2[i] += delta * (x[i] - mean[i]);
+	}
+}
+
+uint8_t __LSM6DS33_converged(const float *m2, float *var_prev, uint32_t n, float scale, float tolerance) {
+	uint8_t converged = 1;
+
+	//!< Дисперсия среднего var / n сравнивается с квадратом допуска, переведенным в цены младшего разряда
+	float tol = tolerance / scale;
+	for(int i = 0; i < 3; i++) {
+		float var = m2[i] / (n - 1);
+		if(var / n > tol * tol || fabsf(var - var_prev[i]) > LSM6DS33_CALIBRATION_VAR_TOL * var) {
+			converged = 0;
+		}
+		var_prev[i] = var;
+	}
+
+	return converged;
+}
+
+HAL_StatusTypeDef LSM6DS33_calibrate(LSM6DS33_t *dev, uint8_t sensors, float tolerance_a, float tolerance_g, uint32_t max_samples, uint32_t timeout, LSM6DS33_calibration_t *result) {
+	HAL_StatusTypeDef status, restore;
+
+	int16_t a_raw[LSM6DS33_FIFO_CHUNK][3];
+	int16_t g_raw[LSM6DS33_FIFO_CHUNK][3];
+	float a_mean[3] = {0}, a_m2[3] = {0}, a_var[3] = {0};
+	float g_mean[3] = {0}, g_m2[3] = {0}, g_var[3] = {0};
+	uint32_t n = 0;
+	uint16_t settle = LSM6DS33_CALIBRATION_SETTLE;
+	uint8_t converged = 0;
+
+	memset(result, 0, sizeof(LSM6DS33_calibration_t));
+	uint8_t a_on = (sensors & LSM6DS33_CALIBRATE_A) != 0;
+	uint8_t g_on = (sensors & LSM6DS33_CALIBRATE_G) != 0;
+	if(!a_on && !g_on) return HAL_ERROR;
+
+	//!< Частоты и FIFO пользователя восстанавливаются после калибровки
+	uint8_t ctrl[2] = {dev->config.CTRL1_config, dev->config.CTRL2_config};
+	uint8_t fifo[5];
+	memcpy(fifo, dev->config.FIFO_config, sizeof(fifo));
+
+	__LSM6DS33_modify_reg(&dev->config.CTRL1_config, LSM6DS33_ODR_MASK, LSM6DS33_ODR_1660HZ << 4);
+	__LSM6DS33_modify_reg(&dev->config.CTRL2_config, LSM6DS33_ODR_MASK, LSM6DS33_ODR_1660HZ << 4);
+	status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL1, &dev->config.CTRL1_config, 2, 0xFF);
+	if(status == HAL_OK) {
+		status = LSM6DS33_config_FIFO(dev, LSM6DS33_FIFO_MODE_CONTINUOUS, LSM6DS33_ODR_1660HZ,
+				a_on ? LSM6DS33_FIFO_DEC_1 : LSM6DS33_FIFO_DEC_OFF, g_on ? LSM6DS33_FIFO_DEC_1 : LSM6DS33_FIFO_DEC_OFF, LSM6DS33_FIFO_CHUNK);
+	}
+
+	uint64_t start = LSM6DS33_time_us();
+	while(status == HAL_OK && !converged) {
+		if(n >= max_samples || LSM6DS33_time_us() - start > (uint64_t)timeout * 1000) {
+			status = HAL_TIMEOUT;
+			break;
+		}
+
+		uint16_t count;
+		if((status = LSM6DS33_FIFO_drain_raw(dev, a_raw, g_raw, LSM6DS33_FIFO_CHUNK, &count)) != HAL_OK) {
+			break;
+		}
+
+		for(uint16_t k = 0; k < count && n < max_samples; k++) {
+			//!< Первые измерения после смены частоты содержат переходный процесс фильтров датчика
+			if(settle) {
+				settle--;
+				continue;
+			}
+
+			n++;
+			if(a_on) __LSM6DS33_welford(a_mean, a_m2, n, a_raw[k]);
+			if(g_on) __LSM6DS33_welford(g_mean, g_m2, n, g_raw[k]);
+		}
+
+		//!< Проверка после каждого блока: сравнение с дисперсией предыдущей проверки отсекает раннюю остановку по неустоявшейся оценке
+		if(count && n >= LSM6DS33_CALIBRATION_MIN_SAMPLES) {
+			converged = 1;
+			if(a_on && !__LSM6DS33_converged(a_m2, a_var, n, dev->scale_A, tolerance_a)) converged = 0;
+			if(g_on && !__LSM6DS33_converged(g_m2, g_var, n, dev->scale_G, tolerance_g)) converged = 0;
+		}
+	}
+
+	dev->config.CTRL1_config = ctrl[0];
+	dev->config.CTRL2_config = ctrl[1];
+	memcpy(dev->config.FIFO_config, fifo, sizeof(fifo));
+
+	uint8_t bypass = LSM6DS33_FIFO_MODE_BYPASS;
+	if((restore = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL1, &dev->config.CTRL1_config, 2, 0xFF)) == HAL_OK &&
+			(restore = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_CTRL5, &bypass, 1, 0xFF)) == HAL_OK) {
+		restore = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_FIFO_CTRL1, dev->config.FIFO_config, 5, 0xFF);
+	}
+	if(status == HAL_OK) status = restore;
+
+	result->samples = n;
+	if(n < 2) return status == HAL_OK ? HAL_TIMEOUT : status;
+
+	uint8_t vertical = 0;
+	for(int i = 0; i < 3; i++) {
+		result->a_bias[i] = a_mean[i] * dev->scale_A;
+		result->g_bias[i] = g_mean[i] * dev->scale_G;
+		result->a_noise[i] = sqrtf(a_m2[i] / (n - 1)) * dev->scale_A;
+		result->g_noise[i] = sqrtf(g_m2[i] / (n - 1)) * dev->scale_G;
+		if(fabsf(a_mean[i]) > fabsf(a_mean[vertical])) vertical = i;
+	}
+	if(a_on) {
+		result->a_bias[vertical] -= a_mean[vertical] > 0 ? 9.80665f : -9.80665f;
+	}
+
+	if(status != HAL_OK) return status;
+
+	LSM6DS33_set_reference(dev, a_on ? result->a_bias : dev->a_ref, g_on ? result->g_bias : dev->g_ref);
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_get_measure_int(LSM6DS33_t *dev, int32_t *a, int32_t *g) {
+	HAL_StatusTypeDef status;
+
+	int16_t raw_data[6];
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_G, (uint8_t*)&raw_data, 12, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	LSM6DS33_G_convert_int(dev, (const int16_t (*)[3])&raw_data[0], (int32_t (*)[3])g, 1);
+	LSM6DS33_A_convert_int(dev, (const int16_t (*)[3])&raw_data[3], (int32_t (*)[3])a, 1);
+
+	return HAL_OK;
+}
+
+void __LSM6DS33_convert(const int16_t (*raw)[3], float (*out)[3], uint16_t count, float scale, const float *ref) {
+#ifdef LSM6DS33_ARM_MATH
+	//!< arm_q15_to_float делит на 32768, поэтому цена младшего разряда умножается на 32768
+	arm_q15_to_float((q15_t*)raw, (float32_t*)out, count * 3);
+	arm_scale_f32((float32_t*)out, scale * 32768.0f, (float32_t*)out, count * 3);
+	for(uint16_t n = 0; n < count; n++) {
+		for(int i = 0; i < 3; i++) {
+			out[n][i] -= ref[i];
+		}
+	}
+#else
+	float r0 = ref[0], r1 = ref[1], r2 = ref[2];
+	for(uint16_t n = 0; n < count; n++) {
+		out[n][0] = raw[n][0] * scale - r0;
+		out[n][1] = raw[n][1] * scale - r1;
+		out[n][2] = raw[n][2] * scale - r2;
+	}
+#endif /* LSM6DS33_ARM_MATH */
+}
+
+void __LSM6DS33_convert_int(const int16_t (*raw)[3], int32_t (*out)[3], uint16_t count, int32_t scale, const int32_t *ref, uint8_t q) {
+	//!< Смещение и округление объединены в одно слагаемое
+	int32_t r0 = (1 << (q - 1)) - ref[0], r1 = (1 << (q - 1)) - ref[1], r2 = (1 << (q - 1)) - ref[2];
+	for(uint16_t n = 0; n < count; n++) {
+		out[n][0] = (raw[n][0] * scale + r0) >> q;
+		out[n][1] = (raw[n][1] * scale + r1) >> q;
+		out[n][2] = (raw[n][2] * scale + r2) >> q;
+	}
+}
+
+void LSM6DS33_A_convert(LSM6DS33_t *dev, const int16_t (*raw)[3], float (*a)[3], uint16_t count) {
+	__LSM6DS33_convert(raw, a, count, dev->scale_A, dev->a_ref);
+}
+
+void LSM6DS33_G_convert(LSM6DS33_t *dev, const int16_t (*raw)[3], float (*g)[3], uint16_t count) {
+	__LSM6DS33_convert(raw, g, count, dev->scale_G, dev->g_ref);
+}
+
+void LSM6DS33_A_convert_int(LSM6DS33_t *dev, const int16_t (*raw)[3], int32_t (*a)[3], uint16_t count) {
+	__LSM6DS33_convert_int(raw, a, count, dev->scale_A_q, dev->a_ref_q, LSM6DS33_SCALE_A_Q);
+}
+
+void LSM6DS33_G_convert_int(LSM6DS33_t *dev, const int16_t (*raw)[3], int32_t (*g)[3], uint16_t count) {
+	__LSM6DS33_convert_int(raw, g, count, dev->scale_G_q, dev->g_ref_q, LSM6DS33_SCALE_G_Q);
+}
+
+HAL_StatusTypeDef LSM6DS33_config_interrupts(LSM6DS33_t *dev, uint8_t INT1, uint8_t INT2) {
+	dev->config.INT_config[0] = INT1;
+	dev->config.INT_config[1] = INT2;
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_INT1_CTRL, dev->config.INT_config, 2, 0xFF);
+}
+
+HAL_StatusTypeDef LSM6DS33_config_wake_up(LSM6DS33_t *dev, float threshold, uint8_t duration) {
+	if(duration > 3) return HAL_ERROR;
+
+	//!< Цена младшего разряда порога - 1/64 диапазона акселерометра, диапазон - 32768 цен младшего разряда
+	float lsb = dev->scale_A * (32768.0f / 64.0f);
+	int32_t ths = (int32_t)(threshold / lsb + 0.5f);
+	if(ths < 1) ths = 1;
+	if(ths > 63) ths = 63;
+
+	__LSM6DS33_modify_reg(&dev->config.MD_config[LSM6DS33_MD_WAKE_UP_THS], LSM6DS33_WAKE_UP_THS_MASK, ths);
+	__LSM6DS33_modify_reg(&dev->config.MD_config[LSM6DS33_MD_WAKE_UP_DUR], LSM6DS33_WAKE_UP_DUR_MASK, duration << 5);
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_WAKE_UP_THS, dev->config.MD_config, 2, 0xFF);
+}
+
+HAL_StatusTypeDef LSM6DS33_config_free_fall(LSM6DS33_t *dev, uint8_t threshold, uint8_t duration) {
+	if(threshold > 0b111 || duration > 63) return HAL_ERROR;
+
+	//!< Старший бит длительности находится в WAKE_UP_DUR, остальные пять - в FREE_FALL
+	__LSM6DS33_modify_reg(&dev->config.MD_config[LSM6DS33_MD_WAKE_UP_DUR], LSM6DS33_WAKE_UP_DUR_FF_DUR5, (duration & 0x20) << 2);
+	dev->config.MD_config[LSM6DS33_MD_FREE_FALL] = ((duration & 0x1F) << 3) | threshold;
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_WAKE_UP_DUR, &dev->config.MD_config[LSM6DS33_MD_WAKE_UP_DUR], 2, 0xFF);
+}
+
+HAL_StatusTypeDef LSM6DS33_config_events(LSM6DS33_t *dev, uint8_t INT1, uint8_t INT2) {
+	HAL_StatusTypeDef status;
+
+	//!< Детектор наклона работает только при включенных встроенных функциях
+	uint8_t tilt = (INT1 | INT2) & LSM6DS33_EVENT_TILT;
+	__LSM6DS33_modify_reg(&dev->config.CTRL10_config, LSM6DS33_CTRL10_FUNC_EN, tilt ? LSM6DS33_CTRL10_FUNC_EN : 0);
+	__LSM6DS33_modify_reg(&dev->config.TAP_config, LSM6DS33_TAP_CFG_TILT_EN | LSM6DS33_TAP_CFG_LIR, (tilt ? LSM6DS33_TAP_CFG_TILT_EN : 0) | LSM6DS33_TAP_CFG_LIR);
+	dev->config.MD_config[LSM6DS33_MD_MD1] = INT1;
+	dev->config.MD_config[LSM6DS33_MD_MD2] = INT2;
+
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_CTRL10, &dev->config.CTRL10_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	//!< Флаги событий защелкиваются до чтения регистров источников, поэтому короткое событие не теряется
+	if((status = I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_TAP_CFG, &dev->config.TAP_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	return I2C_Mem_Write(dev->hi2c, dev->address, LSM6DS33_REGISTER_MD1_CFG, &dev->config.MD_config[LSM6DS33_MD_MD1], 2, 0xFF);
+}
+
+HAL_StatusTypeDef LSM6DS33_get_events(LSM6DS33_t *dev, uint8_t *events) {
+	HAL_StatusTypeDef status;
+
+	uint8_t wake_up_src, func_src;
+	*events = 0;
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_WAKE_UP_SRC, &wake_up_src, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Read(dev->hi2c, dev->address, LSM6DS33_REGISTER_FUNC_SRC, &func_src, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if(wake_up_src & LSM6DS33_WAKE_UP_SRC_WU_IA) *events |= LSM6DS33_EVENT_WAKE_UP;
+	if(wake_up_src & LSM6DS33_WAKE_UP_SRC_FF_IA) *events |= LSM6DS33_EVENT_FREE_FALL;
+	if(func_src & LSM6DS33_FUNC_SRC_TILT_IA) *events |= LSM6DS33_EVENT_TILT;
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef LSM6DS33_confirm_event(LSM6DS33_t *dev, uint8_t condition, float threshold, uint16_t samples, uint8_t *confirmed) {
+	HAL_StatusTypeDef status;
+
+	float a[LSM6DS33_FIFO_CHUNK][3];
+	float g[LSM6DS33_FIFO_CHUNK][3];
+	uint16_t count;
+
+	*confirmed = 0;
+	if(!(dev->config.FIFO_config[2] & 0b111)) return HAL_ERROR;
+
+	if((status = LSM6DS33_FIFO_drain(dev, a, g, LSM6DS33_FIFO_CHUNK, &count)) != HAL_OK) {
+		return status;
+	}
+
+	//!< Сравниваются квадраты модуля ускорения, без извлечения корня
+	float ths2 = threshold * threshold;
+	for(uint16_t n = 0; n < count; n++) {
+		float a2 = a[n][0] * a[n][0] + a[n][1] * a[n][1] + a[n][2] * a[n][2];
+		if(condition == LSM6DS33_CONFIRM_ABOVE ? a2 > ths2 : a2 < ths2) {
+			dev->confirm_hits++;
+		}
+	}
+	dev->confirm_total += count;
+
+	if(dev->confirm_total < samples) {
+		return HAL_BUSY;
+	}
+
+	//!< Событие подтверждается, если условию удовлетворяют не менее 3/4 измерений блока
+	*confirmed = (uint32_t)dev->confirm_hits * 4 >= (uint32_t)dev->confirm_total * 3;
+	dev->confirm_hits = 0;
+	dev->confirm_total = 0;
+
+	return HAL_OK;
+}
+
+#ifdef LSM6DS33_HAL
+__weak uint32_t LSM6DS33_timestamp(void) {
+	return HAL_GetTick();
+}
+
+__weak uint64_t LSM6DS33_time_us(void) {
+	return (uint64_t)HAL_GetTick() * 1000;
+}
+
+LSM6DS33_t *__LSM6DS33_IT_find_busy(I2C_TypeDef *hi2c) {
+	for(int i = 0; i < LSM6DS33_IT_MAX_DEVICES; i++) {
+		if(LSM6DS33_IT_devices[i] && LSM6DS33_IT_devices[i]->hi2c == hi2c && LSM6DS33_IT_devices[i]->IT_busy) {
+			return LSM6DS33_IT_devices[i];
+		}
+	}
+	return NULL;
+}
+
+void __LSM6DS33_IT_schedule(I2C_TypeDef *hi2c) {
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	//!< На одной шине одновременно идет только одно чтение, остальные датчики ждут его окончания в порядке регистрации
+	if(__LSM6DS33_IT_find_busy(hi2c) == NULL) {
+		for(int i = 0; i < LSM6DS33_IT_MAX_DEVICES; i++) {
+			LSM6DS33_t *dev = LSM6DS33_IT_devices[i];
+			if(dev == NULL || dev->hi2c != hi2c || !dev->IT_pending) {
+				continue;
+			}
+
+			dev->IT_read_tick = dev->IT_pending_tick;
+			dev->IT_busy = 1;
+			dev->IT_pending = 0;
+			if(HAL_I2C_Mem_Read_IT(dev->hi2c, dev->address, LSM6DS33_REGISTER_OUT_T, I2C_MEMADD_SIZE_8BIT, (uint8_t*)dev->IT_buffer, 14) == HAL_OK) {
+				break;
+			}
+
+			//!< Шина занята другим обменом: запрос остается в ожидании до окончания обмена или вызова LSM6DS33_IT_get_measure
+			dev->IT_busy = 0;
+			dev->IT_pending = 1;
+			break;
+		}
+	}
+
+	__set_PRIMASK(primask);
+}
+
+void __LSM6DS33_IT_request(LSM6DS33_t *dev, uint32_t tick) {
+	//!< Сигнал готовности держится до чтения данных, поэтому пропущенный фронт повторно не придет.
+	//!< Запоминаем его и читаем сразу после текущего чтения на этой шине
+	dev->IT_pending_tick = tick;
+	dev->IT_pending = 1;
+
+	__LSM6DS33_IT_schedule(dev->hi2c);
+}
+
+HAL_StatusTypeDef LSM6DS33_IT_start(LSM6DS33_t *dev) {
+	int free = -1;
+	for(int i = 0; i < LSM6DS33_IT_MAX_DEVICES; i++) {
+		if(LSM6DS33_IT_devices[i] == dev) {
+			free = i;
+			break;
+		}
+		if(LSM6DS33_IT_devices[i] == NULL && free < 0) {
+			free = i;
+		}
+	}
+	if(free < 0) {
+		return HAL_ERROR;
+	}
+
+	dev->IT_ready = 0;
+	dev->IT_busy = 0;
+	LSM6DS33_IT_devices[free] = dev;
+
+	__LSM6DS33_IT_request(dev, LSM6DS33_timestamp());
+
+	return dev->IT_busy || dev->IT_pending ? HAL_OK : HAL_ERROR;
+}
+
+void LSM6DS33_EXTI_callback(LSM6DS33_t *dev) {
+	__LSM6DS33_IT_request(dev, LSM6DS33_timestamp());
+}
+
+void LSM6DS33_event_callback(LSM6DS33_t *dev) {
+	dev->event_pending = 1;
+}
+
+HAL_StatusTypeDef LSM6DS33_wait_event(LSM6DS33_t *dev, uint32_t timeout, uint8_t *events) {
+	uint32_t start = HAL_GetTick();
+
+	//!< Сон до любого прерывания: МК будит EXTI события или SysTick, по которому проверяется таймаут
+	while(!dev->event_pending) {
+		if(HAL_GetTick() - start >= timeout) {
+			*events = 0;
+			return HAL_TIMEOUT;
+		}
+		__WFI();
+	}
+	dev->event_pending = 0;
+
+	return LSM6DS33_get_events(dev, events);
+}
+
+void LSM6DS33_I2C_callback(I2C_TypeDef *hi2c) {
+	LSM6DS33_t *dev = __LSM6DS33_IT_find_busy(hi2c);
+	if(dev != NULL) {
+		for(int i = 0; i < 7; i++) {
+			dev->IT_raw[i] = dev->IT_buffer[i];
+		}
+		dev->IT_tick = dev->IT_read_tick;
+		dev->IT_ready = 1;
+		dev->IT_busy = 0;
+	}
+
+	//!< Окончание обмена другой библиотеки тоже освобождает шину: отложенное из-за него чтение запускается сейчас
+	__LSM6DS33_IT_schedule(hi2c);
+}
+
+void LSM6DS33_I2C_error_callback(I2C_TypeDef *hi2c) {
+	LSM6DS33_t *dev = __LSM6DS33_IT_find_busy(hi2c);
+	if(dev != NULL) {
+		dev->IT_busy = 0;
+	}
+
+	__LSM6DS33_IT_schedule(hi2c);
+}
+
+uint8_t LSM6DS33_IT_get_measure(LSM6DS33_t *dev, float *a, float *g, float *t, uint32_t *tick) {
+	int16_t raw_data[7];
+
+	//!< Сигнал готовности держится до чтения, поэтому запрос, отложенный из-за занятой шины, повторяется здесь
+	if(dev->IT_pending) {
+		__LSM6DS33_IT_schedule(dev->hi2c);
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	for(int i = 0; i < 7; i++) {
+		raw_data[i] = dev->IT_raw[i];
+	}
+	*tick = dev->IT_tick;
+	uint8_t ready = dev->IT_ready;
+	dev->IT_ready = 0;
+
+	__set_PRIMASK(primask);
+
+	for(int i = 0; i < 3; i++) {
+		g[i] = raw_data[i+1] * dev->scale_G - dev->g_ref[i];
+		a[i] = raw_data[i+4] * dev->scale_A - dev->a_ref[i];
+	}
+	*t = ((float) raw_data[0])*125/(float)0x8000 + 26;
+
+	return ready;
+}
+#endif /* LSM6DS33_HAL */
+
+void LSM6DS33_save(LSM6DS33_t *dev, LSM6DS33_snapshot_t *snapshot) {
+	memset(snapshot, 0, sizeof(LSM6DS33_snapshot_t));
+
+	snapshot->config = dev->config;
+	snapshot->full_scale_A = dev->full_scale_A;
+	snapshot->full_scale_G = dev->full_scale_G;
+	memcpy(snapshot->a_ref, dev->a_ref, sizeof(dev->a_ref));
+	memcpy(snapshot->g_ref, dev->g_ref, sizeof(dev->g_ref));
+
+	Snapshot_seal(snapshot, sizeof(LSM6DS33_snapshot_t), 0x69, dev->address);
+}
+
+HAL_StatusTypeDef LSM6DS33_restore(LSM6DS33_t *dev, I2C_TypeDef *hi2c_, const LSM6DS33_snapshot_t *snapshot) {
+	HAL_StatusTypeDef status;
+
+	uint8_t id = 0;
+	if((status = I2C_Mem_Read(hi2c_, snapshot->header.address, LSM6DS33_REGISTER_ID, &id, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if(!Snapshot_check(snapshot, sizeof(LSM6DS33_snapshot_t), id)) {
+		return HAL_ERROR;
+	}
+
+	dev->hi2c = hi2c_;
+	dev->address = snapshot->header.address;
+	dev->config = snapshot->config;
+	dev->full_scale_A = snapshot->full_scale_A;
+	dev->full_scale_G = snapshot->full_scale_G;
+	memcpy(dev->a_ref, snapshot->a_ref, sizeof(dev->a_ref));
+	memcpy(dev->g_ref, snapshot->g_ref, sizeof(dev->g_ref));
+	memset(&dev->clock, 0, sizeof(LSM6DS33_clock_t));
+	__LSM6DS33_update_scale(dev);
+
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_ORIENT_CFG, &dev->config.ORIENT_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	//!< CTRL7_G и CTRL8_XL идут подряд и в регистрах, и в структуре конфигурации
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL7, &dev->config.CTRL7_config, 2, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	//!< WAKE_UP_THS, WAKE_UP_DUR, FREE_FALL, MD1_CFG и MD2_CFG одной записью
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_WAKE_UP_THS, dev->config.MD_config, 5, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL10, &dev->config.CTRL10_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_TAP_CFG, &dev->config.TAP_config, 1, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_FIFO_CTRL1, dev->config.FIFO_config, 5, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	if((status = I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_INT1_CTRL, dev->config.INT_config, 2, 0xFF)) != HAL_OK) {
+		return status;
+	}
+
+	//!< CTRL1_XL, CTRL2_G и CTRL3_C одной записью
+	return I2C_Mem_Write(hi2c_, dev->address, LSM6DS33_REGISTER_CTRL1, &dev->config.CTRL1_config, 3, 0xFF);
+}
@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include "main.h"
+#include "Snapshot.h"
 
 /** @cond UNNECESSARY */
 #ifdef LSM6DS33_HAL
@@ -32,15 +33,19 @@
 /** @endcond */
 
 
-extern I2C_TypeDef* LSM6DS33_hi2c;		//!< Экземпляр I2C, к которому подключен инерциальный датчик.
 extern float FULL_SCALES_A[4]; 			//!< Хранит значения full-scale для акселерометра. Full-scale определяет максимальный масштаб и точность измерений.
 extern float FULL_SCALES_G[4]; 			//!< Хранит значения full-scale для гироскопа. Full-scale определяет максимальный масштаб и точность измерений.
 
-extern float a_ref[3];					//!< Смещение относительно нуля для ускорений. Используется для калибровки.
-extern float g_ref[3];					//!< Смещение относительно нуля для угловых скоростей. Используется для калибровки.
+/**
+ * @name Адреса датчика на шине I2C
+ * @{
+ */
+#define LSM6DS33_ADDRESS_AUTO					0x00			//!< Автоматическое определение адреса по SA0
+#define LSM6DS33_ADDRESS_0						(0x6A << 1)		//!< SA0 подключен к GND
+#define LSM6DS33_ADDRESS_1						(0x6B << 1)		//!< SA0 подключен к VDDIO
+/** @} */
 
-extern float full_scale_A;				//!< Текущее значение full-scale для акселерометра.
-extern float full_scale_G;  			//!< Текущее значение full-scale для гироскопа.
+#define LSM6DS33_IT_MAX_DEVICES					2				//!< Количество датчиков, читаемых по прерыванию готовности данных
 
 /**
  * @brief Конфигурация датчика
@@ -52,10 +57,111 @@ typedef struct {
 	uint8_t CTRL3_config;					//!< Конфигурация регистра CTRL3_C
 	uint8_t CTRL7_config;					//!< Конфигурация регистра CTRL7_G
 	uint8_t CTRL8_config;					//!< Конфигурация регистра CTRL8_XL
-	uint8_t CTRL10_config;					//!< Конфигурация регистра CTRL10_C
-	uint8_t TAP_config;						//!< Конфигурация дополнительных функций
+	uint8_t CTRL10_config;					//!< Конфигурация регистра CTRL10_C (встроенные функции)
+	uint8_t TAP_config;						//!< Конфигурация регистра TAP_CFG (счетчик времени, наклон, защелка прерываний)
+	uint8_t FIFO_config[5];					//!< Конфигурация регистров FIFO_CTRL1..FIFO_CTRL5
+	uint8_t INT_config[2];					//!< Конфигурация регистров INT1_CTRL и INT2_CTRL
+	uint8_t MD_config[5];					//!< Конфигурация регистров WAKE_UP_THS, WAKE_UP_DUR, FREE_FALL, MD1_CFG и MD2_CFG
 } LSM6DS33_cfg;
 
+/**
+ * @brief Снимок состояния датчика для восстановления после сброса МК
+ * @details Содержит конфигурацию, текущий full-scale и калибровочные смещения. Заполняется функцией @ref LSM6DS33_save,
+ * 	хранится в резервной памяти или flash (см. @ref Snapshot).
+ */
+typedef struct {
+	Snapshot_header_t header;				//!< Заголовок с идентификатором датчика, адресом и CRC
+	LSM6DS33_cfg config;					//!< Копия регистров конфигурации
+	float full_scale_A;						//!< Full-scale акселерометра
+	float full_scale_G;						//!< Full-scale гироскопа
+	float a_ref[3];							//!< Смещения ускорений
+	float g_ref[3];							//!< Смещения угловых скоростей
+} LSM6DS33_snapshot_t;
+
+/**
+ * @brief Соответствие счетчика времени датчика и времени МК
+ * @details Счетчик датчика расширяется до 64 бит, а время МК вычисляется по линейной модели: смещение уточняется
+ * 	при каждой синхронизации, а цена отсчета - по интервалу с первой синхронизации.
+ */
+typedef struct {
+	uint64_t ticks;							//!< Расширенное значение счетчика датчика при последней синхронизации
+	uint32_t raw;							//!< 24-битное значение счетчика при последней синхронизации
+	uint64_t anchor_ticks;					//!< Значение счетчика при первой синхронизации
+	uint64_t anchor_us;						//!< Время МК в мкс при первой синхронизации
+	uint64_t base_ticks;					//!< Опорное значение счетчика модели
+	uint64_t base_us;						//!< Время МК в мкс, соответствующее опорному значению счетчика
+	uint32_t rate_q16;						//!< Цена отсчета счетчика в мкс в формате Q16
+	uint8_t synced;							//!< Выполнена хотя бы одна синхронизация
+} LSM6DS33_clock_t;
+
+/**
+ * @brief Результат калибровки смещений
+ * @details Заполняется функцией @ref LSM6DS33_calibrate. Шум - среднеквадратичное отклонение одного измерения
+ * 	на частоте калибровки, по нему можно проверить, что датчик был неподвижен.
+ */
+typedef struct {
+	float a_bias[3];						//!< Смещения ускорений в м/с^2 без учета силы тяжести
+	float g_bias[3];						//!< Смещения угловых скоростей в град/с
+	float a_noise[3];						//!< Шум ускорений в м/с^2
+	float g_noise[3];						//!< Шум угловых скоростей в град/с
+	uint32_t samples;						//!< Количество использованных измерений
+} LSM6DS33_calibration_t;
+
+#define LSM6DS33_FIFO_SIZE						4096			//!< Размер FIFO в 16-битных словах
+#define LSM6DS33_FIFO_CHUNK						32				//!< Количество измерений, читаемых из FIFO за одну транзакцию I2C (с LSM6DS33_LL - пакетами до 254 байт)
+
+/**
+ * @brief Экземпляр датчика
+ * @details Хранит все состояние одного датчика, поэтому на одной или разных шинах можно использовать несколько датчиков.
+ */
+typedef struct {
+	I2C_TypeDef *hi2c;						//!< Экземпляр I2C, к которому подключен датчик
+	uint16_t address;						//!< Адрес датчика на шине I2C
+	LSM6DS33_cfg config;					//!< Копия регистров конфигурации датчика
+
+	float full_scale_A;						//!< Текущее значение full-scale для акселерометра
+	float full_scale_G;						//!< Текущее значение full-scale для гироскопа
+	float scale_A;							//!< Цена младшего разряда акселерометра в м/с^2. Вычисляется при смене full-scale
+	float scale_G;							//!< Цена младшего разряда гироскопа в град/с. Вычисляется при смене full-scale
+	int32_t scale_A_q;						//!< Цена младшего разряда акселерометра в мм/с^2 в формате Q @ref LSM6DS33_SCALE_A_Q
+	int32_t scale_G_q;						//!< Цена младшего разряда гироскопа в мград/с в формате Q @ref LSM6DS33_SCALE_G_Q
+
+	float a_ref[3];							//!< Смещение относительно нуля для ускорений. Используется для калибровки
+	float g_ref[3];							//!< Смещение относительно нуля для угловых скоростей. Используется для калибровки
+	int32_t a_ref_q[3];						//!< Смещения ускорений в мм/с^2 в формате Q @ref LSM6DS33_SCALE_A_Q. Вычисляются из a_ref
+	int32_t g_ref_q[3];						//!< Смещения угловых скоростей в мград/с в формате Q @ref LSM6DS33_SCALE_G_Q. Вычисляются из g_ref
+
+	LSM6DS33_clock_t clock;					//!< Соответствие счетчика времени датчика и времени МК
+
+	/** @cond UNNECESSARY */
+	int16_t IT_buffer[7];
+	int16_t IT_raw[7];
+	uint32_t IT_read_tick;
+	uint32_t IT_pending_tick;
+	uint32_t IT_tick;
+	volatile uint8_t IT_busy;
+	volatile uint8_t IT_pending;
+	volatile uint8_t IT_ready;
+	volatile uint8_t event_pending;
+	uint16_t confirm_hits;
+	uint16_t confirm_total;
+	int16_t FIFO_buffer[LSM6DS33_FIFO_CHUNK * 9];
+	/** @endcond */
+} LSM6DS33_t;
+
+/**
+ * @name Форматы целочисленной цены младшего разряда
+ * @details Количество дробных бит выбрано так, чтобы произведение на 16-битное значение датчика
+ * 	при максимальном full-scale (0.488 мг и 70 мград/с) помещалось в int32_t. Погрешность округления цены
+ * 	не превышает одного младшего разряда датчика во всем диапазоне.
+ * @{
+ */
+#define LSM6DS33_SCALE_A_Q						12				//!< Дробных бит в @ref LSM6DS33_t::scale_A_q
+#define LSM6DS33_SCALE_G_Q						8				//!< Дробных бит в @ref LSM6DS33_t::scale_G_q
+/** @} */
+
+//#define LSM6DS33_ARM_MATH						//!< Определите, чтобы пакетное преобразование использовало CMSIS-DSP (arm_math.h)
+
 /**
  * @defgroup LSM6DS33_ODR
  * @ingroup LSM6DS33
@@ -172,7 +278,118 @@ typedef struct {
 #define LSM6DS33_FULL_SCALE_2000DPS				0b011
 /** @} */
 
+/**
+ * @defgroup LSM6DS33_FIFO_MODE
+ * @ingroup LSM6DS33
+ * @brief Режим работы FIFO
+ * @details Значения передаются в функцию @ref LSM6DS33_config_FIFO.
+ * @{
+ */
+#define LSM6DS33_FIFO_MODE_BYPASS				0b000			//!< FIFO выключен и очищен
+#define LSM6DS33_FIFO_MODE_FIFO					0b001			//!< Запись останавливается при заполнении FIFO
+#define LSM6DS33_FIFO_MODE_CONTINUOUS			0b110			//!< При заполнении FIFO старые данные перезаписываются новыми
+/** @} */
+
+/**
+ * @defgroup LSM6DS33_FIFO_DECIMATION
+ * @ingroup LSM6DS33
+ * @brief Прореживание данных датчика в FIFO
+ * @details Значения передаются в функцию @ref LSM6DS33_config_FIFO отдельно для акселерометра и гироскопа.
+ * @{
+ */
+#define LSM6DS33_FIFO_DEC_OFF					0b000			//!< Данные датчика не записываются в FIFO
+#define LSM6DS33_FIFO_DEC_1						0b001			//!< Без прореживания
+#define LSM6DS33_FIFO_DEC_2						0b010			//!< Каждое второе измерение
+#define LSM6DS33_FIFO_DEC_3						0b011			//!< Каждое третье измерение
+#define LSM6DS33_FIFO_DEC_4						0b100			//!< Каждое четвертое измерение
+#define LSM6DS33_FIFO_DEC_8						0b101			//!< Каждое восьмое измерение
+#define LSM6DS33_FIFO_DEC_16					0b110			//!< Каждое шестнадцатое измерение
+#define LSM6DS33_FIFO_DEC_32					0b111			//!< Каждое тридцать второе измерение
+/** @} */
+
+/**
+ * @name Флаги состояния FIFO
+ * @{
+ */
+#define LSM6DS33_FIFO_STATUS_WATERMARK			0b10000000		//!< Количество слов в FIFO достигло порога
+#define LSM6DS33_FIFO_STATUS_OVERRUN			0b01000000		//!< FIFO переполнен, данные потеряны
+#define LSM6DS33_FIFO_STATUS_FULL				0b00100000		//!< FIFO будет заполнен при следующей записи
+#define LSM6DS33_FIFO_STATUS_EMPTY				0b00010000		//!< FIFO пуст
+/** @} */
+
+/**
+ * @defgroup LSM6DS33_INT
+ * @ingroup LSM6DS33
+ * @brief Сигналы, выводимые на пины INT1 и INT2
+ * @details Значения объединяются через | и передаются в функцию @ref LSM6DS33_config_interrupts.
+ * 	Сигнал готовности данных держится до чтения выходных регистров.
+ * @{
+ */
+#define LSM6DS33_INT_DRDY_XL					0b00000001		//!< Готовы данные акселерометра
+#define LSM6DS33_INT_DRDY_G						0b00000010		//!< Готовы данные гироскопа
+#define LSM6DS33_INT_FIFO_WATERMARK				0b00001000		//!< Заполнение FIFO достигло порога
+#define LSM6DS33_INT_FIFO_OVERRUN				0b00010000		//!< Переполнение FIFO
+#define LSM6DS33_INT_FIFO_FULL					0b00100000		//!< FIFO заполнен
+/** @} */
+
+/**
+ * @defgroup LSM6DS33_EVENT
+ * @ingroup LSM6DS33
+ * @brief События встроенных детекторов
+ * @details Значения объединяются через | и передаются в функцию @ref LSM6DS33_config_events, возвращаются
+ * 	функциями @ref LSM6DS33_get_events и @ref LSM6DS33_wait_event.
+ * @{
+ */
+#define LSM6DS33_EVENT_WAKE_UP					0b00100000		//!< Ускорение без постоянной составляющей превысило порог (старт)
+#define LSM6DS33_EVENT_FREE_FALL				0b00010000		//!< Модуль ускорения ниже порога (окончание работы двигателя)
+#define LSM6DS33_EVENT_TILT						0b00000010		//!< Наклон более чем на 35 градусов (апогей)
+/** @} */
+
+/**
+ * @defgroup LSM6DS33_FREE_FALL
+ * @ingroup LSM6DS33
+ * @brief Порог детектора свободного падения
+ * @details Значения передаются в функцию @ref LSM6DS33_config_free_fall.
+ * @{
+ */
+#define LSM6DS33_FREE_FALL_156MG				0b000			//!< 156 мg
+#define LSM6DS33_FREE_FALL_219MG				0b001			//!< 219 мg
+#define LSM6DS33_FREE_FALL_250MG				0b010			//!< 250 мg
+#define LSM6DS33_FREE_FALL_312MG				0b011			//!< 312 мg
+#define LSM6DS33_FREE_FALL_344MG				0b100			//!< 344 мg
+#define LSM6DS33_FREE_FALL_406MG				0b101			//!< 406 мg
+#define LSM6DS33_FREE_FALL_469MG				0b110			//!< 469 мg
+#define LSM6DS33_FREE_FALL_500MG				0b111			//!< 500 мg
+/** @} */
+
+/**
+ * @name Условия подтверждения события
+ * @details Значения передаются в функцию @ref LSM6DS33_confirm_event.
+ * @{
+ */
+#define LSM6DS33_CONFIRM_ABOVE					0				//!< Модуль ускорения выше порога
+#define LSM6DS33_CONFIRM_BELOW					1				//!< Модуль ускорения ниже порога
+/** @} */
+
+/**
+ * @name Датчики для калибровки
+ * @details Значения объединяются через | и передаются в функцию @ref LSM6DS33_calibrate.
+ * @{
+ */
+#define LSM6DS33_CALIBRATE_A					0b01			//!< Калибровать акселерометр. Одна из осей должна быть направлена вертикально
+#define LSM6DS33_CALIBRATE_G					0b10			//!< Калибровать гироскоп
+/** @} */
+
+#define LSM6DS33_CALIBRATION_SETTLE				64				//!< Количество измерений, отбрасываемых после смены частоты (40 мс на 1.66 кГц)
+#define LSM6DS33_CALIBRATION_MIN_SAMPLES		128				//!< Минимальное количество измерений для проверки сходимости
+#define LSM6DS33_CALIBRATION_VAR_TOL			0.125f			//!< Допустимое относительное изменение дисперсии между проверками
+
+#define LSM6DS33_TIMESTAMP_LSB_US				25				//!< Цена отсчета счетчика времени датчика в мкс
+#define LSM6DS33_CLOCK_SPAN						40000			//!< Минимальный интервал в отсчетах счетчика (1 с) для оценки его частоты
+#define LSM6DS33_CLOCK_GAIN						16				//!< Делитель поправки смещения при запаздывании времени МК
+
 /** @cond UNNECESSARY */
+#define LSM6DS33_REGISTER_FIFO_CTRL1			0x06
 #define LSM6DS33_REGISTER_FIFO_CTRL4			0x09
 #define LSM6DS33_REGISTER_FIFO_CTRL5			0x0A
 #define LSM6DS33_REGISTER_CTRL1					0x10
@@ -189,6 +406,38 @@ typedef struct {
 #define LSM6DS33_REGISTER_OUT_A					0x28
 #define LSM6DS33_REGISTER_ID					0x0F
 #define LSM6DS33_REGISTER_MD2_CFG				0x5F
+#define LSM6DS33_REGISTER_INT1_CTRL				0x0D
+#define LSM6DS33_REGISTER_FIFO_STATUS1			0x3A
+#define LSM6DS33_REGISTER_FIFO_DATA_OUT			0x3E
+#define LSM6DS33_REGISTER_TIMESTAMP0			0x40
+#define LSM6DS33_REGISTER_TIMESTAMP2			0x42
+#define LSM6DS33_REGISTER_WAKE_UP_THS			0x5B
+#define LSM6DS33_REGISTER_WAKE_UP_DUR			0x5C
+#define LSM6DS33_REGISTER_MD1_CFG				0x5E
+#define LSM6DS33_REGISTER_WAKE_UP_SRC			0x1B
+#define LSM6DS33_REGISTER_FUNC_SRC				0x53
+
+#define LSM6DS33_MD_WAKE_UP_THS					0
+#define LSM6DS33_MD_WAKE_UP_DUR					1
+#define LSM6DS33_MD_FREE_FALL					2
+#define LSM6DS33_MD_MD1							3
+#define LSM6DS33_MD_MD2							4
+
+#define LSM6DS33_WAKE_UP_THS_MASK				0b00111111
+#define LSM6DS33_WAKE_UP_DUR_MASK				0b01100000
+#define LSM6DS33_WAKE_UP_DUR_FF_DUR5			0b10000000
+#define LSM6DS33_TAP_CFG_TILT_EN				0b00100000
+#define LSM6DS33_TAP_CFG_LIR					0b00000001
+#define LSM6DS33_CTRL10_FUNC_EN					0b00000100
+#define LSM6DS33_WAKE_UP_SRC_FF_IA				0b00100000
+#define LSM6DS33_WAKE_UP_SRC_WU_IA				0b00001000
+#define LSM6DS33_FUNC_SRC_TILT_IA				0b00100000
+
+#define LSM6DS33_TAP_CFG_TIMER_EN				0b10000000
+#define LSM6DS33_WAKE_UP_DUR_TIMER_HR			0b00010000
+#define LSM6DS33_FIFO_CTRL2_TIMER_EN			0b10000000
+#define LSM6DS33_TIMESTAMP_RESET				0xAA
+#define LSM6DS33_TIMESTAMP_MASK					0x00FFFFFF
 /** @endcond */
 
 
@@ -200,13 +449,15 @@ void __LSM6DS33_modify_reg(uint8_t *reg_data, uint8_t mask, uint8_t bits);
 /** 
  * @brief Инициализация датчика LSM6DS33
  * @ingroup LSM6DS33
- * @note Автоматически определяет адрес датчика в заваисимости от состояния пина SA0.  
- *  Данная библиотека поддерживает только один подключенный датчик LSM6DS33.
+ * @note При адресе @ref LSM6DS33_ADDRESS_AUTO адрес датчика определяется автоматически в зависимости от состояния пина SA0.
+ * 	Для работы с двумя датчиками на одной шине адрес каждого указывается явно.
  *
+ * @param[out] dev Экземпляр датчика
  * @param[in] hi2c_ Экземпляр интерфейса I2C, к которому подключен датчик
+ * @param[in] address Адрес датчика: @ref LSM6DS33_ADDRESS_0, @ref LSM6DS33_ADDRESS_1 или @ref LSM6DS33_ADDRESS_AUTO
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_init(I2C_HandleTypeDef* hi2c_);
+HAL_StatusTypeDef LSM6DS33_init(LSM6DS33_t *dev, I2C_TypeDef *hi2c_, uint16_t address);
 
 /**
  * @brief Конфигурация ориентации датчика
@@ -215,11 +466,12 @@ HAL_StatusTypeDef LSM6DS33_init(I2C_HandleTypeDef* hi2c_);
  *
  * @note Стандартная система координат датчика совпадает с осями, размеченными на корпусе датчика и имеет порядок X, Y, Z с положительными направлениями.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[in] orient Порядок расположение осей системы координат. Принимает значения макросов @ref LSM6DS33_ORIENT "порядка расположения осей системы координат".
  * @param[in] signs Знаки осей в системе координат. Принимает значения макросов @ref LSM6DS33_ORIENT_SIGN "направлений осей системы координат".
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_config_orientation(uint8_t orient, uint8_t signs);
+HAL_StatusTypeDef LSM6DS33_config_orientation(LSM6DS33_t *dev, uint8_t orient, uint8_t signs);
 
 /**
  * @brief Конфигурация высокочастотных фильтров для гироскопа и акселерометра
@@ -227,23 +479,25 @@ HAL_StatusTypeDef LSM6DS33_config_orientation(uint8_t orient, uint8_t signs);
  * @details Повзоляет настроить высокочастотный фильтр (HPF) для гироскопа и акселерометра.  
  *  Высокочастотный фильтр пропускает резкие движения, отфильтровывает медленные движения и дрейф.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @param[in] g_HPF Режим работы фильтра HPF для гироскопа. Принимает значения макросов @ref LSM6DS33_GYRO_HPF "режима работы фильтра".
  * @param[in] g_HPF_frequency Частота фильтра HPF для гироскопа. Принимает значения макросов @ref LSM6DS33_GYRO_HPF "частоты фильтра для гироскопа".
  * @param[in] a_HPF Частота и режим работы HPF для акселерометра. Принимает значения макросов @ref LSM6DS33_A_FILTER "фильтра high-pass frequency для акселерометра".
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_config_filters(uint8_t g_HPF, uint8_t g_HPF_frequency, uint8_t a_HPF);
+HAL_StatusTypeDef LSM6DS33_config_filters(LSM6DS33_t *dev, uint8_t g_HPF, uint8_t g_HPF_frequency, uint8_t a_HPF);
 
 /**
  * @brief Конфигурация full-scale для гироскопа и акселерометра
  * @ingroup LSM6DS33
  * @details Конфигурирует максимальный масштаб и точность измерений акселерометра и гироскопа.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[in] a_FS Full-scale для акселерометра. Принимает значения макросов @ref LSM5DS33_FULL_SCALE_A "full-scale для акселерометра".
  * @param[in] g_FS Full-scale для гироскопа. Принимает значения макросов @ref LSM6DS33_FULL_SCALE_G "full-scale Для гироскопа".
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_config_full_scale(uint8_t a_FS, uint8_t g_FS);
+HAL_StatusTypeDef LSM6DS33_config_full_scale(LSM6DS33_t *dev, uint8_t a_FS, uint8_t g_FS);
 
 /**
  * @brief Конфигурация режима работы датчика
@@ -251,72 +505,537 @@ HAL_StatusTypeDef LSM6DS33_config_full_scale(uint8_t a_FS, uint8_t g_FS);
  * @details Конфигурирует частоту работы акселерометра и гироскопа. От них зависит качество работы фильтров и измеренных данных,
  * 	а также энергопотребление датчика.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[in] a_ODR Частота работы акселерометра. Принимает значения макросов @ref LSM6DS33_ODR "частоты и питания датчика".
  * @param[in] g_ODR Частота работы гироскопа. Принимает значения макросов @ref LSM6DS33_ODR "частоты и питания датчика".
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_config_perfomance_mode(uint8_t a_ODR, uint8_t g_ODR);
+HAL_StatusTypeDef LSM6DS33_config_perfomance_mode(LSM6DS33_t *dev, uint8_t a_ODR, uint8_t g_ODR);
 
 /**
  * @brief Программная перезагрузка датчика
  * @ingroup LSM6DS33
  * @details Позволяет перезагрузить датчик программно, без отключения питания.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @return HAL_StatusTypeDef Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_reset();
+HAL_StatusTypeDef LSM6DS33_reset(LSM6DS33_t *dev);
 
 /**
  * @brief Снятие измерений с акселерометра
  * @ingroup LSM6DS33
  * @details Получает значения ускорений по трем осям в сконфигурированной системе координат и заданном full-scale.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] a Массив, куда записываются значения ускорений по трем осям
  * @retval status Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_A_get_measure(float *a);
+HAL_StatusTypeDef LSM6DS33_A_get_measure(LSM6DS33_t *dev, float *a);
 
 /**
  * @brief Снятие измерений с гироскопа
  * @ingroup LSM6DS33
  * @details Получает значения угловых скоростей по трем осям в сконфигурированной системе координат и заданном full-scale.
+ * 	Смещения g_ref вычитаются.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] g Массив, куда записываются значений угла отклонения по трем осям
  * @retval status Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_G_get_measure(float *g);
+HAL_StatusTypeDef LSM6DS33_G_get_measure(LSM6DS33_t *dev, float *g);
 
 /**
  * @brief Снятие измерений с термометра
  * @ingroup LSM6DS33
  * @details Получает значение температуры в градусах Цельсия.
  * 
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] t Переменная, куда записывается значение температуры в градусах Цельсиях
  * @retval status Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_T_get_measure(float *t);
+HAL_StatusTypeDef LSM6DS33_T_get_measure(LSM6DS33_t *dev, float *t);
 
 /**
  * @brief Снятие измерений акселерометра и гирокскопа
  * @ingroup LSM6DS33
  * @details Получает значения ускорений и угловых скоростей по трем осям в сконфигурированной системе координат и заданном full-scale.
+ * 	Смещения a_ref и g_ref вычитаются.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] a Массив, куда записываются значения ускорений по трем осям
  * @param[out] g Массив, куда записываются значений угла отклонения по трем осям
  * @retval status Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_get_measure(float* a, float *g);
+HAL_StatusTypeDef LSM6DS33_get_measure(LSM6DS33_t *dev, float* a, float *g);
 
 /**
  * @brief Снятие измерений акселерометра, гирокскопа и термометра
  * @ingroup LSM6DS33
  * @details Получает значения ускорений, угловых скоростей и температуры в сконфигурированной системе координат и заданном full-scale.
  *
+ * @param[in,out] dev Экземпляр датчика
  * @param[out] a Массив, куда записываются значения ускорений по трем осям
  * @param[out] g Массив, куда записываются значений угла отклонения по трем осям
  * @param[out] t Переменная, куда записывается значение температуры в градусах Цельсиях
  * @retval status Результат получения данных по I2C
  */
-HAL_StatusTypeDef LSM6DS33_get_all_measure(float* a, float* g, float* t);
+HAL_StatusTypeDef LSM6DS33_get_all_measure(LSM6DS33_t *dev, float* a, float* g, float* t);
+
+/**
+ * @brief Установка смещений для калибровки
+ * @ingroup LSM6DS33
+ * @details Записывает a_ref и g_ref и пересчитывает их целочисленные копии для функций с суффиксом _int.
+ * 	При изменении a_ref и g_ref напрямую целочисленные функции используют старые смещения.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] a Смещения ускорений по трем осям в м/с^2
+ * @param[in] g Смещения угловых скоростей по трем осям в град/с
+ */
+void LSM6DS33_set_reference(LSM6DS33_t *dev, const float *a, const float *g);
+
+/**
+ * @brief Калибровка смещений неподвижного датчика
+ * @ingroup LSM6DS33
+ * @details На время калибровки акселерометр и гироскоп переводятся на 1.66 кГц, измерения читаются из FIFO блоками
+ * 	и накапливаются алгоритмом Уэлфорда: среднее и дисперсия обновляются за один проход без хранения измерений.
+ * 	Калибровка заканчивается, как только на всех калибруемых осях дисперсия перестает меняться более чем на
+ * 	@ref LSM6DS33_CALIBRATION_VAR_TOL и погрешность среднего становится меньше заданной. Для типичного шума гироскопа
+ * 	и погрешности 0.01 град/с достаточно нескольких сотен измерений, то есть меньше секунды вместо фиксированного ожидания. Затем частоты и FIFO возвращаются к прежней конфигурации.
+ *
+ * 	Смещение ускорения по вертикальной оси (с наибольшим по модулю средним) считается без силы тяжести.
+ * 	При успешной калибровке смещения записываются функцией @ref LSM6DS33_set_reference и вычитаются
+ * 	во всех функциях чтения. Смещения некалибруемого датчика не меняются.
+ * 	\code{.c}
+ * 	LSM6DS33_calibration_t cal;
+ * 	if (LSM6DS33_calibrate(&imu, LSM6DS33_CALIBRATE_G, 0.01f, 0.01f, 5000, 5000, &cal) != HAL_OK) {
+ * 		//!< Датчик двигался или шум выше ожидаемого
+ * 	}
+ * 	\endcode
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] sensors Калибруемые @ref LSM6DS33_CALIBRATE_A "датчики"
+ * @param[in] tolerance_a Допустимая погрешность смещения ускорений в м/с^2
+ * @param[in] tolerance_g Допустимая погрешность смещения угловых скоростей в град/с
+ * @param[in] max_samples Максимальное количество измерений
+ * @param[in] timeout Максимальное время калибровки в мс
+ * @param[out] result Оценки смещений и шума. Заполняются и при неудачной калибровке
+ * @return HAL_StatusTypeDef Результат получения данных по I2C. HAL_TIMEOUT, если оценки не сошлись за max_samples измерений или timeout
+ */
+HAL_StatusTypeDef LSM6DS33_calibrate(LSM6DS33_t *dev, uint8_t sensors, float tolerance_a, float tolerance_g, uint32_t max_samples, uint32_t timeout, LSM6DS33_calibration_t *result);
+
+/**
+ * @brief Снятие измерений акселерометра и гироскопа без вычислений с плавающей точкой
+ * @ingroup LSM6DS33
+ * @details Аналог @ref LSM6DS33_get_all_measure без температуры. Смещения @ref a_ref_q и @ref g_ref_q вычитаются.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] a Массив, куда записываются значения ускорений по трем осям в мм/с^2
+ * @param[out] g Массив, куда записываются значения угловых скоростей по трем осям в мград/с
+ * @retval status Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_get_measure_int(LSM6DS33_t *dev, int32_t *a, int32_t *g);
+
+/**
+ * @brief Пакетное преобразование данных акселерометра
+ * @ingroup LSM6DS33
+ * @details Переводит блок измерений (например, из @ref LSM6DS33_FIFO_drain_raw) в м/с^2 с вычитанием смещений.
+ * 	Цикл без ветвлений векторизуется компилятором на ПК. При определенном LSM6DS33_ARM_MATH используется CMSIS-DSP.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] raw Значения датчика по трем осям
+ * @param[out] a Ускорения по трем осям в м/с^2
+ * @param[in] count Количество измерений
+ */
+void LSM6DS33_A_convert(LSM6DS33_t *dev, const int16_t (*raw)[3], float (*a)[3], uint16_t count);
+
+/**
+ * @brief Пакетное преобразование данных гироскопа
+ * @ingroup LSM6DS33
+ * @details Аналог @ref LSM6DS33_A_convert для угловых скоростей в град/с.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] raw Значения датчика по трем осям
+ * @param[out] g Угловые скорости по трем осям в град/с
+ * @param[in] count Количество измерений
+ */
+void LSM6DS33_G_convert(LSM6DS33_t *dev, const int16_t (*raw)[3], float (*g)[3], uint16_t count);
+
+/**
+ * @brief Пакетное целочисленное преобразование данных акселерометра
+ * @ingroup LSM6DS33
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] raw Значения датчика по трем осям
+ * @param[out] a Ускорения по трем осям в мм/с^2
+ * @param[in] count Количество измерений
+ */
+void LSM6DS33_A_convert_int(LSM6DS33_t *dev, const int16_t (*raw)[3], int32_t (*a)[3], uint16_t count);
+
+/**
+ * @brief Пакетное целочисленное преобразование данных гироскопа
+ * @ingroup LSM6DS33
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] raw Значения датчика по трем осям
+ * @param[out] g Угловые скорости по трем осям в мград/с
+ * @param[in] count Количество измерений
+ */
+void LSM6DS33_G_convert_int(LSM6DS33_t *dev, const int16_t (*raw)[3], int32_t (*g)[3], uint16_t count);
+
+/**
+ * @brief Конфигурация FIFO
+ * @ingroup LSM6DS33
+ * @details Датчик записывает измерения в FIFO объемом 4096 слов без участия МК. Для каждого датчика задается прореживание,
+ * 	порог заполнения выставляет флаг @ref LSM6DS33_FIFO_STATUS_WATERMARK (и прерывание, если оно настроено).
+ * 	Данные читаются функцией @ref LSM6DS33_FIFO_drain.
+ *
+ * 	Если счетчик времени включен функцией @ref LSM6DS33_config_timestamp, в каждое измерение добавляется метка времени.
+ *
+ * @note Частота записи в FIFO не должна превышать частоту работы датчиков, заданную @ref LSM6DS33_config_perfomance_mode.
+ * 	Разбор данных @ref LSM6DS33_FIFO_drain поддерживает одинаковое прореживание акселерометра и гироскопа или
+ * 	запись только одного из них, поэтому при разном ненулевом прореживании функция возвращает HAL_ERROR.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] mode Режим работы FIFO. Принимает значения макросов @ref LSM6DS33_FIFO_MODE "режима работы FIFO".
+ * @param[in] ODR Частота записи в FIFO. Принимает значения макросов @ref LSM6DS33_ODR "частоты датчика".
+ * @param[in] a_dec Прореживание акселерометра. Принимает значения макросов @ref LSM6DS33_FIFO_DECIMATION "прореживания".
+ * @param[in] g_dec Прореживание гироскопа. Принимает значения макросов @ref LSM6DS33_FIFO_DECIMATION "прореживания".
+ * @param[in] watermark Порог заполнения FIFO в измерениях (одно измерение - 3 слова на каждый записываемый датчик и метку времени)
+ * @return HAL_StatusTypeDef HAL_ERROR при неверных параметрах, иначе результат отправки данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_FIFO(LSM6DS33_t *dev, uint8_t mode, uint8_t ODR, uint8_t a_dec, uint8_t g_dec, uint16_t watermark);
+
+/**
+ * @brief Состояние FIFO
+ * @ingroup LSM6DS33
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] words Количество непрочитанных 16-битных слов в FIFO
+ * @param[out] flags Флаги @ref LSM6DS33_FIFO_STATUS_WATERMARK "состояния FIFO"
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_FIFO_status(LSM6DS33_t *dev, uint16_t *words, uint8_t *flags);
+
+/**
+ * @brief Чтение накопленных измерений из FIFO
+ * @ingroup LSM6DS33
+ * @details Одним чтением состояния определяется количество измерений в FIFO, затем измерения читаются блоками по
+ * 	@ref LSM6DS33_FIFO_CHUNK за одну транзакцию (с LSM6DS33_LL, где длина чтения 8-битная, блок делится на пакеты
+ * 	не больше 254 байт) и разбираются на ускорения и угловые скорости в тех же единицах,
+ * 	что и @ref LSM6DS33_get_all_measure. Если FIFO прочитан не с начала измерения (например, после переполнения),
+ * 	неполное измерение отбрасывается.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] a Массив ускорений по трем осям. Может быть NULL, если акселерометр не записывается в FIFO
+ * @param[out] g Массив угловых скоростей по трем осям. Может быть NULL, если гироскоп не записывается в FIFO
+ * @param[in] max_samples Размер массивов в измерениях
+ * @param[out] samples Количество прочитанных измерений
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_FIFO_drain(LSM6DS33_t *dev, float (*a)[3], float (*g)[3], uint16_t max_samples, uint16_t *samples);
+
+/**
+ * @brief Чтение накопленных измерений из FIFO без преобразования
+ * @ingroup LSM6DS33
+ * @details Аналог @ref LSM6DS33_FIFO_drain, возвращающий значения датчика. Блок затем переводится функциями
+ * 	@ref LSM6DS33_A_convert, @ref LSM6DS33_A_convert_int и аналогичными для гироскопа.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] a Массив значений акселерометра по трем осям. Может быть NULL, если акселерометр не записывается в FIFO
+ * @param[out] g Массив значений гироскопа по трем осям. Может быть NULL, если гироскоп не записывается в FIFO
+ * @param[in] max_samples Размер массивов в измерениях
+ * @param[out] samples Количество прочитанных измерений
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_FIFO_drain_raw(LSM6DS33_t *dev, int16_t (*a)[3], int16_t (*g)[3], uint16_t max_samples, uint16_t *samples);
+
+/**
+ * @brief Включение счетчика времени датчика
+ * @ingroup LSM6DS33
+ * @details Счетчик с ценой отсчета @ref LSM6DS33_TIMESTAMP_LSB_US мкс работает от генератора датчика, поэтому
+ * 	метки времени измерений не зависят от задержек на шине I2C. Счетчик сбрасывается, модель времени МК
+ * 	строится заново. Вызывается до @ref LSM6DS33_config_FIFO, чтобы метка времени попала в набор FIFO.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] enable 1 - включить счетчик, 0 - выключить
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_timestamp(LSM6DS33_t *dev, uint8_t enable);
+
+/**
+ * @brief Время МК в мкс
+ * @ingroup LSM6DS33
+ * @details Используется для синхронизации со счетчиком датчика. В сборке HAL по умолчанию возвращает HAL_GetTick в мкс,
+ * 	для точной синхронизации переопределяется пользователем, например чтением счетчика таймера. В сборке LL определяется пользователем.
+ *
+ * @return uint64_t Текущее время в мкс
+ */
+uint64_t LSM6DS33_time_us(void);
+
+/**
+ * @brief Синхронизация счетчика времени датчика с временем МК
+ * @ingroup LSM6DS33
+ * @details Читает счетчик датчика и уточняет модель по @ref LSM6DS33_time_us. Вызывается автоматически
+ * 	в @ref LSM6DS33_FIFO_drain_timed. Интервал между синхронизациями не должен превышать 209 с.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] time Время МК в мкс, соответствующее прочитанному значению счетчика. Может быть NULL
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_time_sync(LSM6DS33_t *dev, uint64_t *time);
+
+/**
+ * @brief Перевод метки времени датчика во время МК
+ * @ingroup LSM6DS33
+ *
+ * @param[in] dev Экземпляр датчика
+ * @param[in] timestamp 24-битное значение счетчика датчика
+ * @return uint64_t Время МК в мкс
+ */
+uint64_t LSM6DS33_time_convert(LSM6DS33_t *dev, uint32_t timestamp);
+
+/**
+ * @brief Чтение накопленных измерений из FIFO с метками времени
+ * @ingroup LSM6DS33
+ * @details Аналог @ref LSM6DS33_FIFO_drain, дополнительно возвращающий для каждого измерения время МК в мкс,
+ * 	вычисленное по метке времени датчика. Интервал между соседними метками равен точному интервалу между измерениями.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] a Массив ускорений по трем осям. Может быть NULL, если акселерометр не записывается в FIFO
+ * @param[out] g Массив угловых скоростей по трем осям. Может быть NULL, если гироскоп не записывается в FIFO
+ * @param[out] time Массив времени измерений в мкс
+ * @param[in] max_samples Размер массивов в измерениях
+ * @param[out] samples Количество прочитанных измерений
+ * @return HAL_StatusTypeDef Результат получения данных по I2C. HAL_ERROR, если метки времени не записываются в FIFO
+ */
+HAL_StatusTypeDef LSM6DS33_FIFO_drain_timed(LSM6DS33_t *dev, float (*a)[3], float (*g)[3], uint64_t *time, uint16_t max_samples, uint16_t *samples);
+
+/**
+ * @brief Конфигурация пинов прерываний
+ * @ingroup LSM6DS33
+ * @details Задает сигналы, выводимые на INT1 и INT2. Оба регистра записываются одной транзакцией.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] INT1 Сигналы пина INT1. Принимает значения макросов @ref LSM6DS33_INT "сигналов прерываний".
+ * @param[in] INT2 Сигналы пина INT2. Принимает значения макросов @ref LSM6DS33_INT "сигналов прерываний".
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_interrupts(LSM6DS33_t *dev, uint8_t INT1, uint8_t INT2);
+
+/**
+ * @brief Конфигурация детектора старта
+ * @ingroup LSM6DS33
+ * @details Событие @ref LSM6DS33_EVENT_WAKE_UP возникает, когда ускорение по любой оси после фильтра верхних частот
+ * 	превышает порог заданное количество измерений. Порог округляется до 1/64 текущего full-scale акселерометра,
+ * 	поэтому функция вызывается после @ref LSM6DS33_config_full_scale.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] threshold Порог в м/с^2
+ * @param[in] duration Длительность превышения порога в измерениях акселерометра, от 0 до 3
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_wake_up(LSM6DS33_t *dev, float threshold, uint8_t duration);
+
+/**
+ * @brief Конфигурация детектора окончания работы двигателя
+ * @ingroup LSM6DS33
+ * @details Событие @ref LSM6DS33_EVENT_FREE_FALL возникает, когда модуль ускорения меньше порога заданное количество
+ * 	измерений. После окончания работы двигателя ракета движется по баллистической траектории и акселерометр
+ * 	измеряет только сопротивление воздуха.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] threshold Порог. Принимает значения макросов @ref LSM6DS33_FREE_FALL "порога свободного падения".
+ * @param[in] duration Длительность в измерениях акселерометра, от 0 до 63
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_free_fall(LSM6DS33_t *dev, uint8_t threshold, uint8_t duration);
+
+/**
+ * @brief Вывод событий на пины прерываний
+ * @ingroup LSM6DS33
+ * @details Включает встроенные функции, если выбран детектор наклона, и защелкивание флагов событий
+ * 	до вызова @ref LSM6DS33_get_events.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] INT1 События пина INT1. Принимает значения макросов @ref LSM6DS33_EVENT "событий".
+ * @param[in] INT2 События пина INT2. Принимает значения макросов @ref LSM6DS33_EVENT "событий".
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_config_events(LSM6DS33_t *dev, uint8_t INT1, uint8_t INT2);
+
+/**
+ * @brief Чтение произошедших событий
+ * @ingroup LSM6DS33
+ * @details Чтение сбрасывает защелкнутые флаги и сигнал на пине прерывания.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] events Флаги @ref LSM6DS33_EVENT "событий"
+ * @return HAL_StatusTypeDef Результат получения данных по I2C
+ */
+HAL_StatusTypeDef LSM6DS33_get_events(LSM6DS33_t *dev, uint8_t *events);
+
+/**
+ * @brief Программное подтверждение события по блоку FIFO
+ * @ingroup LSM6DS33
+ * @details После аппаратного события читается следующий блок измерений акселерометра из FIFO. Событие подтверждается,
+ * 	если не менее 3/4 измерений блока удовлетворяют условию, что отсеивает одиночные удары и вибрации.
+ * 	Функция вызывается повторно, пока возвращает HAL_BUSY. Рекомендуемые условия: старт - ускорение выше 3g,
+ * 	окончание работы двигателя и апогей - ниже 0.5g.
+ * 	\code{.c}
+ * 	LSM6DS33_config_wake_up(&imu, 2 * 9.81f, 2);
+ * 	LSM6DS33_config_events(&imu, LSM6DS33_EVENT_WAKE_UP, 0);
+ * 	while (LSM6DS33_wait_event(&imu, 1000, &events) != HAL_OK || !(events & LSM6DS33_EVENT_WAKE_UP));
+ * 	while (LSM6DS33_confirm_event(&imu, LSM6DS33_CONFIRM_ABOVE, 3 * 9.81f, 32, &launch) == HAL_BUSY);
+ * 	\endcode
+ *
+ * @note Акселерометр должен записываться в FIFO (@ref LSM6DS33_config_FIFO).
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] condition Условие: @ref LSM6DS33_CONFIRM_ABOVE или @ref LSM6DS33_CONFIRM_BELOW
+ * @param[in] threshold Порог модуля ускорения в м/с^2
+ * @param[in] samples Количество измерений в блоке подтверждения
+ * @param[out] confirmed 1, если событие подтверждено
+ * @return HAL_StatusTypeDef Результат получения данных по I2C. HAL_BUSY, если блок еще не набран
+ */
+HAL_StatusTypeDef LSM6DS33_confirm_event(LSM6DS33_t *dev, uint8_t condition, float threshold, uint16_t samples, uint8_t *confirmed);
+
+#ifdef LSM6DS33_HAL
+/**
+ * @brief Метка времени измерения
+ * @ingroup LSM6DS33
+ * @details Вызывается в прерывании готовности данных. По умолчанию возвращает HAL_GetTick в мс.
+ * 	Для точных меток времени переопределяется пользователем, например чтением счетчика таймера в мкс.
+ *
+ * @return uint32_t Текущее время
+ */
+uint32_t LSM6DS33_timestamp(void);
+
+/**
+ * @brief Запуск чтения измерений по прерыванию готовности данных
+ * @ingroup LSM6DS33
+ * @details Предварительно сигнал готовности гироскопа или акселерометра выводится на пин функцией
+ * 	@ref LSM6DS33_config_interrupts, а пин настраивается в CubeMX как EXTI по переднему фронту.
+ * 	Функция регистрирует датчик и запускает первое чтение, которое сбрасывает сигнал готовности, если он уже был выставлен.
+ * 	Датчики на одной шине читаются по очереди: чтение датчика, фронт которого пришел во время чужого чтения,
+ * 	запускается сразу после его окончания. Одновременно регистрируется до @ref LSM6DS33_IT_MAX_DEVICES датчиков.
+ * 	\code{.c}
+ * 	LSM6DS33_t imu0, imu1;
+ * 	LSM6DS33_init(&imu0, &hi2c1, LSM6DS33_ADDRESS_0);
+ * 	LSM6DS33_init(&imu1, &hi2c1, LSM6DS33_ADDRESS_1);
+ * 	LSM6DS33_config_interrupts(&imu0, LSM6DS33_INT_DRDY_G, 0);
+ * 	LSM6DS33_config_interrupts(&imu1, LSM6DS33_INT_DRDY_G, 0);
+ * 	LSM6DS33_IT_start(&imu0);
+ * 	LSM6DS33_IT_start(&imu1);
+ *
+ * 	void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+ * 		if (GPIO_Pin == IMU0_INT1_Pin) LSM6DS33_EXTI_callback(&imu0);
+ * 		if (GPIO_Pin == IMU1_INT1_Pin) LSM6DS33_EXTI_callback(&imu1);
+ * 	}
+ * 	void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c) {
+ * 		LSM6DS33_I2C_callback(hi2c);
+ * 	}
+ * 	void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+ * 		LSM6DS33_I2C_error_callback(hi2c);
+ * 	}
+ * 	\endcode
+ *
+ * @note Только для HAL: чтение выполняется функцией HAL_I2C_Mem_Read_IT.
+ * @param[in,out] dev Экземпляр датчика
+ * @return HAL_StatusTypeDef Результат запуска чтения по I2C. HAL_ERROR, если зарегистрировано максимальное количество датчиков
+ */
+HAL_StatusTypeDef LSM6DS33_IT_start(LSM6DS33_t *dev);
+
+/**
+ * @brief Обработка фронта сигнала готовности данных
+ * @ingroup LSM6DS33
+ * @details Вызывается из HAL_GPIO_EXTI_Callback. Запоминает метку времени и запускает неблокирующее чтение
+ * 	температуры, гироскопа и акселерометра одной транзакцией. Если на шине еще идет чтение этого или другого датчика,
+ * 	новое запускается сразу после его окончания.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ */
+void LSM6DS33_EXTI_callback(LSM6DS33_t *dev);
+
+/**
+ * @brief Обработка прерывания события
+ * @ingroup LSM6DS33
+ * @details Вызывается из HAL_GPIO_EXTI_Callback для пина, на который выведены события @ref LSM6DS33_config_events.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ */
+void LSM6DS33_event_callback(LSM6DS33_t *dev);
+
+/**
+ * @brief Ожидание события в режиме сна
+ * @ingroup LSM6DS33
+ * @details МК засыпает инструкцией WFI до прерывания @ref LSM6DS33_event_callback, затем читает флаги событий.
+ * 	Опрос акселерометра во время ожидания не выполняется.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[in] timeout Время ожидания в мс
+ * @param[out] events Флаги @ref LSM6DS33_EVENT "событий"
+ * @return HAL_StatusTypeDef Результат получения данных по I2C. HAL_TIMEOUT, если событие не произошло
+ */
+HAL_StatusTypeDef LSM6DS33_wait_event(LSM6DS33_t *dev, uint32_t timeout, uint8_t *events);
+
+/**
+ * @brief Обработка окончания чтения
+ * @ingroup LSM6DS33
+ * @details Вызывается из HAL_I2C_MemRxCpltCallback. Публикует прочитанное измерение с меткой времени
+ * 	и запускает чтение следующего ожидающего датчика на этой шине. После обмена другой библиотеки
+ * 	только запускается отложенное чтение.
+ *
+ * @param[in] hi2c Экземпляр I2C, на котором завершилось чтение
+ */
+void LSM6DS33_I2C_callback(I2C_TypeDef *hi2c);
+
+/**
+ * @brief Обработка ошибки чтения
+ * @ingroup LSM6DS33
+ * @details Вызывается из HAL_I2C_ErrorCallback. Освобождает шину и запускает чтение следующего ожидающего датчика.
+ *
+ * @param[in] hi2c Экземпляр I2C, на котором произошла ошибка
+ */
+void LSM6DS33_I2C_error_callback(I2C_TypeDef *hi2c);
+
+/**
+ * @brief Получение последнего измерения, прочитанного по прерыванию
+ * @ingroup LSM6DS33
+ * @details Копирует измерение с запретом прерываний и переводит в те же единицы, что и @ref LSM6DS33_get_all_measure.
+ * 	Если чтение было отложено, потому что шина была занята, функция запускает его повторно.
+ *
+ * @param[in,out] dev Экземпляр датчика
+ * @param[out] a Массив, куда записываются значения ускорений по трем осям
+ * @param[out] g Массив, куда записываются значения угловых скоростей по трем осям
+ * @param[out] t Переменная, куда записывается значение температуры в градусах Цельсия
+ * @param[out] tick Метка времени @ref LSM6DS33_timestamp фронта готовности данных
+ * @return uint8_t 1, если с прошлого вызова получено новое измерение, иначе 0
+ */
+uint8_t LSM6DS33_IT_get_measure(LSM6DS33_t *dev, float *a, float *g, float *t, uint32_t *tick);
+#endif /* LSM6DS33_HAL */
+
+/**
+ * @brief Сохранение состояния датчика в снимок
+ * @ingroup LSM6DS33
+ * @details Обращений к шине нет. Вызывается после инициализации, конфигурации и калибровки.
+ *
+ * @param[in] dev Экземпляр датчика
+ * @param[out] snapshot Снимок
+ */
+void LSM6DS33_save(LSM6DS33_t *dev, LSM6DS33_snapshot_t *snapshot);
+
+/**
+ * @brief Восстановление состояния датчика из снимка
+ * @ingroup LSM6DS33
+ * @details Вместо поиска датчика выполняется одно чтение идентификатора по адресу из снимка. Если идентификатор и CRC
+ * 	снимка совпали, конфигурация и калибровочные смещения восстанавливаются из снимка, а регистры конфигурации
+ * 	записываются в датчик повторно.
+ *
+ * @param[out] dev Экземпляр датчика
+ * @param[in] hi2c_ Экземпляр интерфейса I2C, к которому подключен датчик
+ * @param[in] snapshot Снимок, сохраненный @ref LSM6DS33_save
+ * @return HAL_StatusTypeDef Результат обмена по I2C. HAL_ERROR, если снимок поврежден или не соответствует датчику
+ */
+HAL_StatusTypeDef LSM6DS33_restore(LSM6DS33_t *dev, I2C_TypeDef *hi2c_, const LSM6DS33_snapshot_t *snapshot);
 
 #endif /* INC_LSM6DS33_H_ */
\ No newline at end of file
@@ -23,6 +23,20 @@ HAL_StatusTypeDef SPI__wait_flag(SPI_TypeDef *SPIx, uint8_t bit, uint8_t timeout
 }
 
 
+HAL_StatusTypeDef SPI__wait_idle(SPI_TypeDef *SPIx, uint8_t timeout) {
+	uint32_t start_wait = HAL_GetTick();
+
+	//!< BSY сбрасывается, когда последний байт полностью выдвинут на шину
+	while ((SPIx->SR & SPI_SR_BSY) == SPI_SR_BSY) {
+		if (HAL_GetTick() - start_wait > timeout) {
+			return HAL_BUSY;
+		}
+	}
+
+	return HAL_OK;
+}
+
+
 HAL_StatusTypeDef LL_SPI_Transmit(SPI_TypeDef *SPIx, uint8_t *buffer, uint8_t bytes_count, uint8_t timeout) {
 	HAL_StatusTypeDef status = HAL_OK;
 
@@ -35,39 +49,43 @@ HAL_StatusTypeDef LL_SPI_Transmit(SPI_TypeDef *SPIx, uint8_t *buffer, uint8_t by
 		
 		//!< Помещаем в него данные буфера
 		LL_SPI_TransmitData8(SPIx, buffer[i]);
-
-		//!< Ждем пока передача закончится
-		if ((status = SPI__wait_flag(SPIx, SPI_SR_BSY, timeout)) != HAL_OK) {
-			return status;
-		}
 	}
 
-	return status;
+	//!< Ждем, пока последний байт уйдет на шину, чтобы после возврата можно было поднять CS
+	return SPI__wait_idle(SPIx, timeout);
 }
 
 
-HAL_StatusTypeDef LL_SPI_Receive(SPI *SPIx, uint8_t **buffer, uint8_t bytes_count, uint8_t timeout) {
+HAL_StatusTypeDef LL_SPI_Receive(SPI_TypeDef *SPIx, uint8_t *buffer, uint8_t bytes_count, uint8_t timeout) {
 	HAL_StatusTypeDef status = HAL_OK;
 
-	//!< Проверка, занят ли SPI
-	if ((status = SPI__wait_flag(SPIx, SPI_SR_BSY, timeout)) != HAL_OK) {
+	//!< Ждем окончания предыдущей передачи
+	if ((status = SPI__wait_idle(SPIx, timeout)) != HAL_OK) {
 		return status;
 	}
+
+	//!< После передачи в регистре данных остается принятый байт, а в SR может быть выставлен OVR.
+	//!< Чтение DR и затем SR сбрасывает оба
+	(void)LL_SPI_ReceiveData8(SPIx);
+	(void)SPIx->SR;
 	
 	for (int i = 0; i < bytes_count; i++) {
-		
-		//!<  Ждем пока данные поступят в сдвиговый регистр
-		if ((status = SPI__wait_flag(SPIx, SPI_ST_RXNE, timeout)) != HAL_OK) {
+
+		//!< Ждем пока сдвиговый регистр освободится
+		if ((status = SPI__wait_flag(SPIx, SPI_SR_TXE, timeout)) != HAL_OK) {
 			return status;
 		}
 
-		//!< Записываем данные
-		(*buffer)[i] = LL_SPI_ReceiveData8(SPIx);
+		//!< Пустой байт тактирует шину, одновременно с ним принимается байт устройства
+		LL_SPI_TransmitData8(SPIx, 0xFF);
 		
-		//!< Ждем пока прием закончится
-		if ((status = SPI__wait_flag(SPIx, SPI_SR_BSY, timeout)) != HAL_OK) {
+		//!<  Ждем пока данные поступят в сдвиговый регистр
+		if ((status = SPI__wait_flag(SPIx, SPI_SR_RXNE, timeout)) != HAL_OK) {
 			return status;
 		}
+
+		//!< Записываем данные
+		buffer[i] = LL_SPI_ReceiveData8(SPIx);
 	}
 
 	return status;
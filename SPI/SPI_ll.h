@@ -28,6 +28,14 @@
  */
 HAL_StatusTypeDef SPI__wait_flag(SPI_TypeDef *SPIx, uint8_t bit, uint8_t timeout);
 
+/**
+ * @brief Дополнительная внутрянняя функция ожидания окончания обмена по SPI
+ * @param SPIx SPI, для которого была вызвана функция для отправки или приема данных
+ * @param timeout Время ожидания сброса флага BSY
+ * @retval status **HAL_BUSY**, если по истечении времени шина осталась занятой, иначе **HAL_OK**
+ */
+HAL_StatusTypeDef SPI__wait_idle(SPI_TypeDef *SPIx, uint8_t timeout);
+
 /**
  * @brief Отправка байтов по шине SPI
  * @param SPIx SPI, на который отправляются данные
@@ -43,8 +51,10 @@ HAL_StatusTypeDef LL_SPI_Transmit(SPI_TypeDef *SPIx, uint8_t *data, uint8_t byte
 
 /**
  * @brief Прием байтов с шины SPI
+ * @details Ведущий должен сам тактировать шину, поэтому для каждого принимаемого байта отправляется байт 0xFF.
+ * Перед приемом из регистра данных удаляется байт, оставшийся после предыдущей передачи.
  * @param SPIx SPI, с которого отправляются данные
- * @param buffer Указатель на буффер данных, куда записываются данные. Указатель нужен для изменения переданного буффера
+ * @param buffer Буффер данных, куда записываются принятые данные
  * @param bytes_count Размер буффера в байтах
  * @param timeout Время ожидания изменения какого либо флага во время приема данных
  * @retval status Результат приема данных. Может быть 
@@ -52,6 +62,6 @@ HAL_StatusTypeDef LL_SPI_Transmit(SPI_TypeDef *SPIx, uint8_t *data, uint8_t byte
  * 					- **HAL_ERROR** - если по истечении времени флаг не изменился на указанный
  *  				- **HAL_OK** - в остальных случаях
  */
-HAL_StatusTypeDef LL_SPI_Receive(SPI *SPIx, uint8_t **buffer, uint8_t bytes_count, uint8_t timeout);
+HAL_StatusTypeDef LL_SPI_Receive(SPI_TypeDef *SPIx, uint8_t *buffer, uint8_t bytes_count, uint8_t timeout);
 
 #endif /* INC_SPI_LL_C_ */
\ No newline at end of file
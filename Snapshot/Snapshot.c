@@ -0,0 +1,78 @@
+#include <stddef.h>
+#include "Snapshot.h"
+
+//!< Таблица CRC32 на полубайт: 64 байта flash вместо 1 КБ для побайтовой таблицы
+const uint32_t Snapshot_crc_table[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+
+uint32_t Snapshot_crc32(uint32_t crc, const void *data, uint32_t size) {
+	const uint8_t *bytes = data;
+
+	crc = ~crc;
+	for (uint32_t i = 0; i < size; i++) {
+		crc = Snapshot_crc_table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+		crc = Snapshot_crc_table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+	}
+
+	return ~crc;
+}
+
+
+uint32_t __Snapshot_crc(const void *snapshot, uint16_t size) {
+	//!< Поле crc в расчет не входит: считаем CRC заголовка до него и данных после заголовка
+	uint32_t crc = Snapshot_crc32(0, snapshot, offsetof(Snapshot_header_t, crc));
+
+	return Snapshot_crc32(crc, (const uint8_t *)snapshot + sizeof(Snapshot_header_t), size - sizeof(Snapshot_header_t));
+}
+
+
+void Snapshot_seal(void *snapshot, uint16_t size, uint8_t chip_id, uint8_t address) {
+	Snapshot_header_t *header = snapshot;
+
+	header->magic = SNAPSHOT_MAGIC;
+	header->size = size;
+	header->chip_id = chip_id;
+	header->address = address;
+	header->crc = __Snapshot_crc(snapshot, size);
+}
+
+
+uint8_t Snapshot_check(const void *snapshot, uint16_t size, uint8_t chip_id) {
+	const Snapshot_header_t *header = snapshot;
+
+	if (header->magic != SNAPSHOT_MAGIC || header->size != size || header->chip_id != chip_id) {
+		return 0;
+	}
+
+	return header->crc == __Snapshot_crc(snapshot, size);
+}
+
+
+HAL_StatusTypeDef Snapshot_write_flash(uint32_t page_address, const void *snapshot, uint16_t size) {
+	HAL_StatusTypeDef status;
+
+	FLASH_EraseInitTypeDef erase = {0};
+	erase.TypeErase = FLASH_TYPEERASE_PAGES;
+	erase.PageAddress = page_address;
+	erase.NbPages = 1;
+	uint32_t page_error;
+
+	HAL_FLASH_Unlock();
+
+	if ((status = HAL_FLASHEx_Erase(&erase, &page_error)) == HAL_OK) {
+		//!< Flash F103 записывается полусловами. Размер снимков кратен 4 из-за полей uint32_t
+		const uint16_t *data = snapshot;
+		for (uint16_t i = 0; i < size / 2; i++) {
+			if ((status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, page_address + 2 * i, data[i])) != HAL_OK) {
+				break;
+			}
+		}
+	}
+
+	HAL_FLASH_Lock();
+
+	return status;
+}
@@ -0,0 +1,94 @@
+/**
+ * @defgroup Snapshot Snapshot
+ * @brief Сохранение состояния драйверов датчиков для быстрого восстановления после перезапуска МК.
+ * @details Драйвер копирует в снимок калибровочные коэффициенты и конфигурацию датчика, снимок защищается
+ * 	идентификатором датчика и CRC32. Снимок хранится в резервной памяти (BKPSRAM, переживает сброс МК) или в странице flash.
+ * 	После сброса в полете драйвер проверяет снимок и восстанавливает состояние вместо полной инициализации с поиском
+ * 	датчика и чтением калибровки.
+ *
+ * 	Пример для страницы flash:
+ * 	\code{.c}
+ * 	BMx280_snapshot_t snapshot;
+ * 	BMx280_save(&baro, &snapshot);
+ * 	Snapshot_write_flash(SNAPSHOT_PAGE, &snapshot, sizeof(snapshot));
+ * 	...
+ * 	if (BMx280_restore(&baro, &hi2c1, (const BMx280_snapshot_t *)SNAPSHOT_PAGE) != HAL_OK) {
+ * 		BMx280_init(&baro, &hi2c1, BMx280_ADDRESS_AUTO, ref_pressure);
+ * 	}
+ * 	\endcode
+ */
+/**
+ * @file Snapshot.h
+ * @ingroup Snapshot
+ * @brief API проверки и записи снимков состояния драйверов
+ *
+ * @author Rafael Abeldinov
+ * @date 19.10.2026
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "main.h"
+
+#define SNAPSHOT_MAGIC					0x50414E53			//!< Сигнатура снимка ("SNAP")
+
+/**
+ * @brief Заголовок снимка. Должен быть первым полем структуры снимка драйвера
+ */
+typedef struct {
+	uint32_t magic;					//!< Сигнатура @ref SNAPSHOT_MAGIC
+	uint16_t size;					//!< Размер снимка вместе с заголовком в байтах
+	uint8_t chip_id;				//!< Идентификатор датчика (регистр WHO_AM_I / ID), для которого сделан снимок
+	uint8_t address;				//!< Адрес датчика на шине I2C
+	uint32_t crc;					//!< CRC32 снимка без учета этого поля
+} Snapshot_header_t;
+
+/**
+ * @brief Вычисление CRC32 (полином 0xEDB88320)
+ * @ingroup Snapshot
+ *
+ * @param[in] crc Начальное значение. 0 для первого блока, результат предыдущего вызова для продолжения
+ * @param[in] data Данные
+ * @param[in] size Размер данных в байтах
+ * @return uint32_t CRC32 данных
+ */
+uint32_t Snapshot_crc32(uint32_t crc, const void *data, uint32_t size);
+
+/**
+ * @brief Заполнение заголовка снимка
+ * @ingroup Snapshot
+ * @details Вызывается драйвером после заполнения полей снимка.
+ *
+ * @param[in,out] snapshot Снимок, первым полем которого является @ref Snapshot_header_t
+ * @param[in] size Размер снимка в байтах
+ * @param[in] chip_id Идентификатор датчика
+ * @param[in] address Адрес датчика на шине I2C
+ */
+void Snapshot_seal(void *snapshot, uint16_t size, uint8_t chip_id, uint8_t address);
+
+/**
+ * @brief Проверка снимка
+ * @ingroup Snapshot
+ *
+ * @param[in] snapshot Снимок
+ * @param[in] size Ожидаемый размер снимка
+ * @param[in] chip_id Идентификатор, прочитанный из датчика
+ * @return uint8_t 1, если сигнатура, размер, идентификатор и CRC совпали, иначе 0
+ */
+uint8_t Snapshot_check(const void *snapshot, uint16_t size, uint8_t chip_id);
+
+/**
+ * @brief Запись снимка в страницу flash
+ * @ingroup Snapshot
+ * @details Стирает страницу и записывает снимок по полусловам (STM32F103). Страница должна быть исключена из области
+ * 	программы в скрипте компоновщика. Снимок читается напрямую по адресу страницы.
+ *
+ * @param[in] page_address Адрес начала страницы flash
+ * @param[in] snapshot Снимок
+ * @param[in] size Размер снимка в байтах
+ * @return HAL_StatusTypeDef Результат стирания и записи flash
+ */
+HAL_StatusTypeDef Snapshot_write_flash(uint32_t page_address, const void *snapshot, uint16_t size);
+
+#endif /* SNAPSHOT_H_ */